@@ -5,49 +5,302 @@
  * Client: The Client is responsible for using the Component interface to work with objects in the composition. It treats both Leaf and Composite objects uniformly.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <memory>
 #include <sstream>
 #include <stack>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // ==================== Composite Pattern Core Classes ====================
 
+class Department;
+class Company;
+
 // component interface
 class Component {
 public:
     virtual ~Component() = default;
     virtual void display(int depth) const = 0;
     virtual std::string getName() const = 0;
+
+    // leaves have no children; lets traversals walk the tree without recursion.
+    // slots vacated by Department::remove stay null until the next compaction, so walkers skip nulls.
+    virtual const std::vector<std::shared_ptr<Component>>* getChildren() const {
+        return nullptr;
+    }
+
+    // subtree aggregates: employees in this subtree (a leaf counts itself) and departments below this node
+    virtual size_t getHeadcount() const = 0;
+    virtual size_t getDepartmentCount() const = 0;
+
+    Department* getParent() const {
+        return parent_;
+    }
+
+private:
+    friend class Department;  // only a department attaches children, so only it sets the back link
+    Department* parent_ = nullptr;
+    size_t slot_ = 0;  // position in parent's children, makes removal O(1)
+};
+
+
+// renders a subtree with an explicit stack instead of recursion, so depth is bounded by heap, not call stack.
+// lines are accumulated in one buffer and indentation is sliced from a single run of spaces.
+class TreeRenderer {
+public:
+    TreeRenderer(std::ostream& out) : out_(out) {}
+
+    ~TreeRenderer() {
+        flush();
+    }
+
+    void render(const Component& root, int depth) {
+        std::vector<std::pair<const Component*, int>> pending;
+        pending.push_back({&root, depth});
+
+        while (!pending.empty()) {
+            auto [node, level] = pending.back();
+            pending.pop_back();
+            writeLine(node->getName(), level);
+
+            const auto* children = node->getChildren();
+            if (children == nullptr) {
+                continue;
+            }
+            // push in reverse so that children pop in their original order
+            for (auto it = children->rbegin(); it != children->rend(); ++it) {
+                if (*it) {
+                    pending.push_back({it->get(), level + 1});
+                }
+            }
+        }
+    }
+
+    void writeLine(std::string_view text, int depth = 0) {
+        size_t width = static_cast<size_t>(depth) * 2;
+        if (indent_.size() < width) {
+            indent_.resize(std::max(width, indent_.size() * 2), ' ');
+        }
+        buffer_.append(indent_, 0, width);
+        buffer_ += text;
+        buffer_ += '\n';
+
+        if (buffer_.size() >= BUFFER_SIZE) {
+            out_.write(buffer_.data(), buffer_.size());
+            buffer_.clear();
+        }
+    }
+
+    void flush() {
+        out_.write(buffer_.data(), buffer_.size());
+        buffer_.clear();
+        out_.flush();
+    }
+
+private:
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+
+    std::ostream& out_;
+    std::string buffer_;
+    std::string indent_;
 };
 
 // composite
 class Department : public Component {
 private:
+    friend class Company;  // moves within one company go around the index hooks below
+
     std::string name_;
     std::vector<std::shared_ptr<Component>> children_;
+    size_t vacantSlots_ = 0;
+    Company* company_ = nullptr;  // the company whose tree this department is in; null while detached
+
+    // aggregates are computed on first query and cached until a descendant changes
+    mutable size_t headcount_ = 0;
+    mutable size_t departmentCount_ = 0;
+    mutable bool aggregatesValid_ = true;  // an empty department has nothing to count
+
+    // mark this node and its ancestors stale. An invalid node always has invalid ancestors,
+    // so the walk stops at the first one that is already stale.
+    void invalidateAggregates() {
+        for (Department* dept = this; dept != nullptr && dept->aggregatesValid_; dept = dept->getParent()) {
+            dept->aggregatesValid_ = false;
+        }
+    }
+
+    // post-order over the stale part of the subtree only; valid subtrees are reused as-is
+    void refreshAggregates() const {
+        std::vector<std::pair<const Department*, bool>> pending;  // node, children already pushed
+        pending.push_back({this, false});
+
+        while (!pending.empty()) {
+            auto& [dept, expanded] = pending.back();
+            if (!expanded) {
+                expanded = true;
+                const Department* parent = dept;  // pending may reallocate below
+                for (const auto& child : parent->children_) {
+                    auto* sub = dynamic_cast<const Department*>(child.get());
+                    if (sub != nullptr && !sub->aggregatesValid_) {
+                        pending.push_back({sub, false});
+                    }
+                }
+                continue;
+            }
+
+            size_t headcount = 0;
+            size_t departmentCount = 0;
+            for (const auto& child : dept->children_) {
+                if (!child) {
+                    continue;
+                }
+                headcount += child->getHeadcount();
+                departmentCount += child->getDepartmentCount() + (child->getChildren() != nullptr ? 1 : 0);
+            }
+            dept->headcount_ = headcount;
+            dept->departmentCount_ = departmentCount;
+            dept->aggregatesValid_ = true;
+            pending.pop_back();
+        }
+    }
+
+    // squeeze out vacant slots once they make up half of the vector, keeping sibling order
+    void compactChildren() {
+        size_t next = 0;
+        for (auto& child : children_) {
+            if (child) {
+                child->slot_ = next;
+                children_[next++] = std::move(child);
+            }
+        }
+        children_.resize(next);
+        vacantSlots_ = 0;
+    }
+
+    // a department that outlives its company (or its parent in one) is detached, and so is its subtree
+    static void forgetCompany(Department& top) {
+        if (top.company_ == nullptr) {
+            return;
+        }
+        std::vector<Department*> pending = {&top};
+        while (!pending.empty()) {
+            Department* dept = pending.back();
+            pending.pop_back();
+            dept->company_ = nullptr;
+            for (const auto& child : dept->children_) {
+                if (child && child->getChildren() != nullptr) {
+                    pending.push_back(static_cast<Department*>(child.get()));
+                }
+            }
+        }
+    }
+
+    // link and unlink a child without telling the company; add() and remove() wrap these
+    void attach(std::shared_ptr<Component> component) {
+        component->parent_ = this;
+        component->slot_ = children_.size();
+        children_.push_back(std::move(component));
+        invalidateAggregates();
+    }
+
+    std::shared_ptr<Component> detach(Component& child) {
+        std::shared_ptr<Component> detached = std::move(children_[child.slot_]);
+        child.parent_ = nullptr;
+        child.slot_ = 0;
+
+        if (++vacantSlots_ * 2 > children_.size()) {
+            compactChildren();
+        }
+        invalidateAggregates();
+        return detached;
+    }
 
 public:
     Department(const std::string& name) : name_(name) {}
 
+    // release the subtree iteratively; the default member-wise destruction would recurse once per level.
+    // Every released child loses its back link, since a child still owned elsewhere outlives its parent.
+    ~Department() override {
+        std::vector<std::shared_ptr<Component>> pending = std::move(children_);
+        for (auto& child : pending) {
+            if (child) {
+                child->parent_ = nullptr;
+            }
+        }
+        while (!pending.empty()) {
+            std::shared_ptr<Component> node = std::move(pending.back());
+            pending.pop_back();
+
+            auto dept = std::dynamic_pointer_cast<Department>(node);
+            if (dept && dept.use_count() == 2) {  // only node and dept own it, it dies here
+                for (auto& child : dept->children_) {
+                    if (child) {
+                        child->parent_ = nullptr;
+                        pending.push_back(std::move(child));
+                    }
+                }
+                dept->children_.clear();
+            } else if (dept) {
+                forgetCompany(*dept);  // owned elsewhere, so it survives without a parent
+            }
+        }
+    }
+
     std::string getName() const override {
         return name_;
     }
 
-    void add(std::shared_ptr<Component> component) {
-        children_.push_back(component);
+    const std::vector<std::shared_ptr<Component>>* getChildren() const override {
+        return &children_;
     }
 
-    void display(int depth) const override {
-        for (int i = 0; i < depth; ++i) {
-            std::cout << "  ";
+    // a component belongs to exactly one department, so one that already has a parent (or is a company's
+    // root) is refused; detach it with remove first. Adding costs O(depth) for invalidation, plus a walk of
+    // the new subtree when this department is in a company, which then takes the subtree into its index.
+    bool add(std::shared_ptr<Component> component);
+
+    // detach a direct child, preserving the order of its siblings. The slot is left empty and reclaimed
+    // by an occasional compaction, so removal is amortized O(1) plus the ancestor invalidation, plus a walk of
+    // the subtree when this department is in a company, which then drops the subtree from its index.
+    std::shared_ptr<Component> remove(Component& child);
+
+    size_t getHeadcount() const override {
+        if (!aggregatesValid_) {
+            refreshAggregates();
         }
-        std::cout << name_ << std::endl;
+        return headcount_;
+    }
 
-        for (const auto& child : children_) {
-            child->display(depth + 1);
+    size_t getDepartmentCount() const override {
+        if (!aggregatesValid_) {
+            refreshAggregates();
         }
+        return departmentCount_;
+    }
+
+    void display(int depth) const override {
+        TreeRenderer renderer(std::cout);
+        renderer.render(*this, depth);
     }
 };
 
@@ -63,11 +316,17 @@ public:
         return name_;
     }
 
+    size_t getHeadcount() const override {
+        return 1;
+    }
+
+    size_t getDepartmentCount() const override {
+        return 0;
+    }
+
     void display(int depth) const override {
-        for (int i = 0; i < depth; ++i) {
-            std::cout << "  ";
-        }
-        std::cout << name_ << std::endl;
+        TreeRenderer renderer(std::cout);
+        renderer.render(*this, depth);
     }
 };
 
@@ -75,22 +334,468 @@ public:
 class Company {
 private:
     std::shared_ptr<Department> root_;
+    // name -> nodes with that name (names need not be unique). Built on the first lookup or removal, so plain
+    // load-and-display runs never pay for it; kept in sync by add/remove from then on.
+    mutable std::unordered_map<std::string, std::unordered_set<Component*>> index_;
+    mutable bool indexed_ = false;
+
+    friend class Department;  // reports subtrees joining and leaving the tree
+
+    // visit every node of a subtree, parents before children
+    template <typename Fn>
+    static void forEachNode(Component& root, Fn&& fn) {
+        if (root.getChildren() == nullptr) {  // adding a single employee is the common case
+            fn(root);
+            return;
+        }
+        std::vector<Component*> pending = {&root};
+        while (!pending.empty()) {
+            Component* node = pending.back();
+            pending.pop_back();
+            fn(*node);
+            if (const auto* children = node->getChildren()) {
+                for (const auto& child : *children) {
+                    if (child) {
+                        pending.push_back(child.get());
+                    }
+                }
+            }
+        }
+    }
+
+    void ensureIndex() const {
+        if (indexed_) {
+            return;
+        }
+        forEachNode(*root_, [this](Component& node) {
+            index_[node.getName()].insert(&node);
+        });
+        indexed_ = true;
+    }
+
+    // O(1): the node's entry is found by name, then by pointer within that name's set
+    void unindex(Component& node) {
+        auto found = index_.find(node.getName());
+        if (found == index_.end()) {
+            return;
+        }
+        found->second.erase(&node);
+        if (found->second.empty()) {
+            index_.erase(found);
+        }
+    }
+
+    // a subtree joined the tree: its departments now belong here and its names go into the index
+    void adopt(Component& subtree) {
+        forEachNode(subtree, [this](Component& member) {
+            if (member.getChildren() != nullptr) {
+                static_cast<Department&>(member).company_ = this;
+            }
+            if (indexed_) {
+                index_[member.getName()].insert(&member);
+            }
+        });
+    }
+
+    // a subtree left the tree: the reverse of adopt
+    void release(Component& subtree) {
+        forEachNode(subtree, [this](Component& member) {
+            if (member.getChildren() != nullptr) {
+                static_cast<Department&>(member).company_ = nullptr;
+            }
+            if (indexed_) {
+                unindex(member);
+            }
+        });
+    }
 
 public:
     Company(const std::string& name) {
         root_ = std::make_shared<Department>(name);
+        root_->company_ = this;
+    }
+
+    // departments point back here, so a company stays put; nodes that outlive it are left detached
+    Company(const Company&) = delete;
+    Company& operator=(const Company&) = delete;
+
+    // only a root someone else still holds needs unhooking; a dying root unhooks its survivors itself
+    ~Company() {
+        if (root_.use_count() > 1) {
+            Department::forgetCompany(*root_);
+        }
     }
 
     std::shared_ptr<Department> getRoot() const {
         return root_;
     }
 
+    // ---- mutations that keep the name index in sync ----
+
+    // attach a node (or a whole prebuilt subtree) under parent; same as parent.add(component).
+    // A node that already has a parent is refused; use move() to reparent.
+    bool add(Department& parent, std::shared_ptr<Component> component) {
+        return parent.add(std::move(component));
+    }
+
+    // reparent a subtree; names don't change, so the index is untouched. O(1) for employees, departments
+    // additionally walk newParent's ancestors to refuse moving a department under itself.
+    bool move(Component& node, Department& newParent) {
+        Department* oldParent = node.getParent();
+        if (oldParent == nullptr) {
+            return false;  // the root stays where it is
+        }
+        if (node.getChildren() != nullptr) {
+            for (const Department* dept = &newParent; dept != nullptr; dept = dept->getParent()) {
+                if (dept == &node) {
+                    return false;
+                }
+            }
+        }
+        if (oldParent->company_ == newParent.company_) {
+            newParent.attach(oldParent->detach(node));
+        } else {
+            newParent.add(oldParent->remove(node));  // into another tree: both indexes must hear about it
+        }
+        return true;
+    }
+
+    // detach a subtree and drop its names from the index; the caller gets the only remaining owner
+    std::shared_ptr<Component> remove(Component& node) {
+        Department* parent = node.getParent();
+        if (parent == nullptr) {
+            return nullptr;
+        }
+        return parent->remove(node);
+    }
+
+    // every node with this name, in no particular order
+    std::vector<Component*> find(const std::string& name) const {
+        ensureIndex();
+        auto found = index_.find(name);
+        if (found == index_.end()) {
+            return {};
+        }
+        return std::vector<Component*>(found->second.begin(), found->second.end());
+    }
+
     void display() const {
-        std::cout << "Company Structure:" << std::endl;
-        root_->display(0);
+        TreeRenderer renderer(std::cout);
+        renderer.writeLine("Company Structure:");
+        renderer.render(*root_, 0);
+    }
+};
+
+bool Department::add(std::shared_ptr<Component> component) {
+    if (!component || component->parent_ != nullptr) {
+        return false;
+    }
+    if (component->getChildren() != nullptr && static_cast<Department&>(*component).company_ != nullptr) {
+        return false;  // a parentless department that belongs to a company is that company's root
+    }
+    Component& node = *component;
+    attach(std::move(component));
+    if (company_ != nullptr) {
+        company_->adopt(node);
+    }
+    return true;
+}
+
+std::shared_ptr<Component> Department::remove(Component& child) {
+    if (child.parent_ != this) {
+        return nullptr;
+    }
+    if (company_ != nullptr) {
+        company_->release(child);
+    }
+    return detach(child);
+}
+
+// ==================== Parallel Traversal ====================
+
+// fixed set of workers, each owning a deque of tasks. A worker pushes and pops at the back of its own deque
+// (depth-first, cache friendly) and, when it runs dry, steals from the front of the others (oldest, largest tasks).
+class WorkStealingPool {
+public:
+    WorkStealingPool(size_t workers = std::max(1u, std::thread::hardware_concurrency())) {
+        for (size_t i = 0; i < workers; ++i) {
+            queues_.push_back(std::make_unique<TaskQueue>());
+        }
+        for (size_t i = 0; i < workers; ++i) {
+            threads_.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    size_t size() const {
+        return threads_.size();
+    }
+
+    // tasks submitted from a worker go to that worker's own deque, others are spread round-robin
+    void submit(std::function<void()> task) {
+        size_t target = (currentPool_ == this) ? currentWorker_ : nextQueue_++ % queues_.size();
+        pending_++;
+        {
+            // counted before the task becomes visible, so a worker's decrement can never run first
+            std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+            queued_++;
+            queues_[target]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);  // pairs with the predicate check in workerLoop
+        }
+        wake_.notify_one();
+    }
+
+    // blocks until every submitted task, including the ones spawned by tasks, has finished
+    void wait() {
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        idle_.wait(lock, [this] { return pending_ == 0; });
+    }
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool takeTask(size_t self, std::function<void()>& task) {
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            TaskQueue& queue = *queues_[(self + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+            if (i == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            queued_--;
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(size_t self) {
+        currentPool_ = this;
+        currentWorker_ = self;
+
+        std::function<void()> task;
+        while (true) {
+            if (takeTask(self, task)) {
+                task();
+                task = nullptr;
+                if (--pending_ == 0) {
+                    std::lock_guard<std::mutex> lock(sleepMutex_);
+                    idle_.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            wake_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+            if (stopping_ && queued_ == 0) {
+                return;
+            }
+        }
     }
+
+    static inline thread_local const WorkStealingPool* currentPool_ = nullptr;
+    static inline thread_local size_t currentWorker_ = 0;
+
+    std::vector<std::unique_ptr<TaskQueue>> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> nextQueue_{0};
+    std::atomic<size_t> pending_{0};  // submitted but not finished
+    std::atomic<size_t> queued_{0};   // submitted but not picked up yet
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    bool stopping_ = false;
 };
 
+
+// Walks a subtree in pre-order on a WorkStealingPool. A task owns a range of siblings; a range heavier than
+// 2 * grain nodes is halved and the right half becomes a new task with its own result chunk. The chunk is
+// linked into the parent's output at the exact place the right half would have been visited, so flattening
+// the chunks afterwards yields the serial pre-order result no matter which worker ran what.
+//
+// Visit: void(const Component& node, int depth, Result& out). Merge: void(Result& into, Result&& next).
+// Subtree sizes come from the cached aggregates, which are refreshed up front by the calling thread.
+template <typename Result, typename Visit, typename Merge>
+Result traverseParallel(WorkStealingPool& pool, const Component& root, int depth, Visit visit, Merge merge,
+                        size_t grain = 4096) {
+    using Children = std::vector<std::shared_ptr<Component>>;
+
+    struct Chunk;
+    struct Piece {
+        Result value;                  // results visited before sub
+        std::unique_ptr<Chunk> sub;    // output of a spawned task, or null for the trailing piece
+    };
+    struct Chunk {
+        std::vector<Piece> pieces;
+    };
+    struct Frame {
+        const Children* siblings;
+        size_t begin;
+        size_t end;
+        int depth;
+        bool fresh;                    // only new ranges are considered for splitting
+        std::unique_ptr<Chunk> marker; // set: splice this chunk here instead of visiting
+    };
+
+    auto subtreeSize = [](const Component& node) {
+        return node.getHeadcount() + node.getDepartmentCount() + (node.getChildren() != nullptr ? 1 : 0);
+    };
+    auto heavierThan = [&](const Frame& frame, size_t limit) {
+        size_t weight = 0;
+        for (size_t i = frame.begin; i < frame.end && weight < limit; ++i) {
+            if (const auto& child = (*frame.siblings)[i]) {
+                weight += subtreeSize(*child);
+            }
+        }
+        return weight >= limit;
+    };
+
+    std::function<void(Frame, Chunk*)> runTask = [&](Frame range, Chunk* out) {
+        Result current{};
+        std::vector<Frame> frames;
+        frames.push_back(std::move(range));
+
+        while (!frames.empty()) {
+            Frame frame = std::move(frames.back());
+            frames.pop_back();
+
+            if (frame.marker) {
+                out->pieces.push_back({std::move(current), std::move(frame.marker)});
+                current = Result{};
+                continue;
+            }
+
+            if (frame.fresh && frame.end - frame.begin > 1 && heavierThan(frame, 2 * grain)) {
+                size_t mid = frame.begin + (frame.end - frame.begin) / 2;
+                auto chunk = std::make_unique<Chunk>();
+                Chunk* target = chunk.get();
+                pool.submit([&runTask, target, siblings = frame.siblings, mid, end = frame.end, level = frame.depth] {
+                    runTask({siblings, mid, end, level, true, nullptr}, target);
+                });
+                frames.push_back({nullptr, 0, 0, 0, false, std::move(chunk)});
+                frames.push_back({frame.siblings, frame.begin, mid, frame.depth, true, nullptr});
+                continue;
+            }
+
+            const Component* node = (*frame.siblings)[frame.begin].get();
+            if (frame.begin + 1 < frame.end) {
+                frames.push_back({frame.siblings, frame.begin + 1, frame.end, frame.depth, false, nullptr});
+            }
+            if (node == nullptr) {
+                continue;
+            }
+            visit(*node, frame.depth, current);
+            const Children* children = node->getChildren();
+            if (children != nullptr && !children->empty()) {
+                frames.push_back({children, 0, children->size(), frame.depth + 1, true, nullptr});
+            }
+        }
+        out->pieces.push_back({std::move(current), nullptr});
+    };
+
+    subtreeSize(root);  // refresh stale aggregates before workers start reading them
+
+    Result result{};
+    visit(root, depth, result);
+    const Children* children = root.getChildren();
+    if (children == nullptr || children->empty()) {
+        return result;
+    }
+
+    auto top = std::make_unique<Chunk>();
+    pool.submit([&runTask, target = top.get(), children, depth] {
+        runTask({children, 0, children->size(), depth + 1, true, nullptr}, target);
+    });
+    pool.wait();
+
+    // flatten in order; sub chunks are moved onto the stack so they are released one by one, not recursively
+    std::vector<std::pair<std::unique_ptr<Chunk>, size_t>> stack;
+    stack.push_back({std::move(top), 0});
+    while (!stack.empty()) {
+        auto& [chunk, index] = stack.back();
+        if (index == chunk->pieces.size()) {
+            stack.pop_back();
+            continue;
+        }
+        Piece& piece = chunk->pieces[index++];
+        merge(result, std::move(piece.value));
+        if (piece.sub) {
+            auto sub = std::move(piece.sub);
+            stack.push_back({std::move(sub), 0});
+        }
+    }
+    return result;
+}
+
+
+// same text as Department::display, rendered in parallel
+std::string renderParallel(WorkStealingPool& pool, const Component& root, int depth = 0) {
+    return traverseParallel<std::string>(pool, root, depth,
+        [](const Component& node, int level, std::string& out) {
+            out.append(static_cast<size_t>(level) * 2, ' ');
+            out += node.getName();
+            out += '\n';
+        },
+        [](std::string& into, std::string&& next) {
+            into += next;
+        });
+}
+
+// every node with the given name, in pre-order
+std::vector<const Component*> findParallel(WorkStealingPool& pool, const Component& root, const std::string& name) {
+    using Matches = std::vector<const Component*>;
+    return traverseParallel<Matches>(pool, root, 0,
+        [&name](const Component& node, int, Matches& out) {
+            if (node.getName() == name) {
+                out.push_back(&node);
+            }
+        },
+        [](Matches& into, Matches&& next) {
+            into.insert(into.end(), next.begin(), next.end());
+        });
+}
+
+struct Totals {
+    size_t employees = 0;
+    size_t departments = 0;
+};
+
+// recounts the subtree by visiting every node, including the root itself
+Totals totalsParallel(WorkStealingPool& pool, const Component& root) {
+    return traverseParallel<Totals>(pool, root, 0,
+        [](const Component& node, int, Totals& out) {
+            if (node.getChildren() != nullptr) {
+                out.departments++;
+            } else {
+                out.employees++;
+            }
+        },
+        [](Totals& into, Totals&& next) {
+            into.employees += next.employees;
+            into.departments += next.departments;
+        });
+}
+
 // ==================== Parser and Tree builder ====================
 
 // DTO
@@ -162,7 +867,7 @@ public:
                 // top node, add to root
                 if (node.type == "D") {
                     auto dept = std::make_shared<Department>(node.name);
-                    company.getRoot()->add(dept);
+                    company.add(*company.getRoot(), dept);
                     lastDepartment = dept;
                     
                     // reset stack
@@ -174,7 +879,7 @@ public:
                 else if (node.type == "E") {
                     // add employee to most recent dep
                     auto emp = std::make_shared<Employee>(node.name);
-                    lastDepartment->add(emp);
+                    company.add(*lastDepartment, emp);
                 }
             } 
             else {
@@ -186,41 +891,447 @@ public:
 
                 if (node.type == "D") {
                     auto dept = std::make_shared<Department>(node.name);
-                    parent->add(dept);
+                    company.add(*parent, dept);
                     departmentStack.push(dept);
                     lastDepartment = dept;
                 } 
                 else if (node.type == "E") {
                     auto emp = std::make_shared<Employee>(node.name);
-                    parent->add(emp);
+                    company.add(*parent, emp);
                 }
             }
         }
     }
 };
 
-// ==================== Entry ====================
-
-int main() {
-    std::ios_base::sync_with_stdio(false);
-    std::cin.tie(NULL);
-
-    // Read company name
+// company name line, node count line, then the indented nodes
+std::unique_ptr<Company> readCompany(std::istream& input) {
     std::string companyName;
-    std::getline(std::cin, companyName);
-    Company company(companyName);
+    std::getline(input, companyName);
+    auto company = std::make_unique<Company>(companyName);
 
-    // Read number of nodes
     int n;
-    std::cin >> n;
-    std::cin.ignore();
+    input >> n;
+    input.ignore();
 
     Parser parser;
     TreeBuilder builder;
+    auto nodes = parser.parse(input, n);
+    builder.build(*company, nodes);
+    return company;
+}
+
+// ==================== Binary Snapshot ====================
+
+// On-disk layout, native endianness:
+//   SnapshotHeader | SnapshotNode[nodeCount] | string pool (poolSize bytes)
+// Nodes are stored in pre-order, node 0 being the company root. subtreeEnd is the index one past the node's
+// last descendant, so subtrees can be skipped or iterated without any pointers.
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nodeCount;
+    uint64_t poolSize;
+};
+
+struct SnapshotNode {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t depth;
+    uint32_t subtreeEnd;
+    uint32_t isDepartment;
+};
+
+constexpr char SNAPSHOT_MAGIC[8] = {'O', 'R', 'G', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+// flatten the tree into the node table; identical names share one pool entry
+bool saveSnapshot(const Company& company, const std::string& path) {
+    std::vector<SnapshotNode> nodes;
+    std::string pool;
+    std::unordered_map<std::string, uint32_t> pooled;
+
+    struct Pending {
+        const Component* node;
+        uint32_t depth;
+        bool leaving;      // second visit: all descendants written, close the subtree
+        uint32_t index;
+    };
+    std::vector<Pending> pending = {{company.getRoot().get(), 0, false, 0}};
+
+    while (!pending.empty()) {
+        Pending current = pending.back();
+        pending.pop_back();
+        if (current.leaving) {
+            nodes[current.index].subtreeEnd = static_cast<uint32_t>(nodes.size());
+            continue;
+        }
+
+        std::string name = current.node->getName();
+        auto [it, inserted] = pooled.emplace(name, static_cast<uint32_t>(pool.size()));
+        if (inserted) {
+            pool += name;
+        }
+        const auto* children = current.node->getChildren();
+        uint32_t index = static_cast<uint32_t>(nodes.size());
+        nodes.push_back({it->second, static_cast<uint32_t>(name.size()), current.depth, index + 1,
+                         children != nullptr ? 1u : 0u});
+
+        if (children == nullptr) {
+            continue;
+        }
+        pending.push_back({current.node, current.depth, true, index});
+        for (auto child = children->rbegin(); child != children->rend(); ++child) {
+            if (*child) {
+                pending.push_back({child->get(), current.depth + 1, false, 0});
+            }
+        }
+    }
+
+    SnapshotHeader header{};
+    std::copy(std::begin(SNAPSHOT_MAGIC), std::end(SNAPSHOT_MAGIC), header.magic);
+    header.version = SNAPSHOT_VERSION;
+    header.nodeCount = static_cast<uint32_t>(nodes.size());
+    header.poolSize = pool.size();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(SnapshotNode));
+    out.write(pool.data(), pool.size());
+    return static_cast<bool>(out);
+}
+
+
+// read-only view over a snapshot file. open() is one mmap plus a header check; nodes and names are read
+// straight out of the mapping, nothing is parsed or allocated per node.
+class CompanySnapshot {
+public:
+    CompanySnapshot() = default;
+    CompanySnapshot(const CompanySnapshot&) = delete;
+    CompanySnapshot& operator=(const CompanySnapshot&) = delete;
+
+    ~CompanySnapshot() {
+        close();
+    }
+
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SnapshotHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+        data_ = static_cast<const char*>(mapped);
+        length_ = info.st_size;
+
+        const auto* header = reinterpret_cast<const SnapshotHeader*>(data_);
+        // no sum of file-supplied sizes: the node table must fit first, then the pool is exactly what is left
+        size_t body = length_ - sizeof(SnapshotHeader);
+        if (!std::equal(std::begin(SNAPSHOT_MAGIC), std::end(SNAPSHOT_MAGIC), header->magic)
+            || header->version != SNAPSHOT_VERSION || header->nodeCount == 0
+            || header->nodeCount > body / sizeof(SnapshotNode)
+            || header->poolSize != body - size_t(header->nodeCount) * sizeof(SnapshotNode)) {
+            close();
+            return false;
+        }
+        nodes_ = reinterpret_cast<const SnapshotNode*>(data_ + sizeof(SnapshotHeader));
+        if (!validTree(nodes_, header->nodeCount)) {
+            close();
+            return false;
+        }
+        pool_ = reinterpret_cast<const char*>(nodes_ + header->nodeCount);
+        nodeCount_ = header->nodeCount;
+        poolSize_ = header->poolSize;
+        return true;
+    }
+
+    void close() {
+        if (data_ != nullptr) {
+            ::munmap(const_cast<char*>(data_), length_);
+        }
+        data_ = nullptr;
+        nodes_ = nullptr;
+        pool_ = nullptr;
+        length_ = nodeCount_ = poolSize_ = 0;
+    }
+
+    size_t size() const {
+        return nodeCount_;
+    }
+
+    const SnapshotNode& node(size_t index) const {
+        return nodes_[index];
+    }
+
+    // names are bounds-checked on access instead of validating the whole table at open()
+    std::string_view name(size_t index) const {
+        const SnapshotNode& entry = nodes_[index];
+        if (size_t(entry.nameOffset) + entry.nameLength > poolSize_) {
+            return {};
+        }
+        return {pool_ + entry.nameOffset, entry.nameLength};
+    }
+
+    // same bytes as Company::display on the tree the snapshot was taken from
+    void display(std::ostream& out) const {
+        TreeRenderer renderer(out);
+        renderer.writeLine("Company Structure:");
+        for (size_t i = 0; i < nodeCount_; ++i) {
+            renderer.writeLine(name(i), nodes_[i].depth);
+        }
+    }
+
+    // back to the indented "D name" / "E name" input format. Like the parser, it cannot express an employee
+    // sitting directly under the company after a top-level department; such employees read back into that department.
+    void exportText(std::ostream& out) const {
+        std::string line;
+        out << name(0) << '\n' << nodeCount_ - 1 << '\n';
+        for (size_t i = 1; i < nodeCount_; ++i) {
+            line.assign(size_t(nodes_[i].depth - 1) * 2, ' ');
+            line += nodes_[i].isDepartment ? "D " : "E ";
+            line += name(i);
+            line += '\n';
+            out.write(line.data(), line.size());
+        }
+        out.flush();
+    }
+
+    // materialize a mutable tree, for callers that need to reorganize it
+    std::unique_ptr<Company> toCompany() const {
+        auto company = std::make_unique<Company>(std::string(name(0)));
+        std::vector<std::shared_ptr<Department>> path = {company->getRoot()};
+        for (size_t i = 1; i < nodeCount_; ++i) {
+            path.resize(nodes_[i].depth);  // parent sits at depth - 1
+            std::string nodeName(name(i));
+            if (nodes_[i].isDepartment) {
+                auto dept = std::make_shared<Department>(nodeName);
+                company->add(*path.back(), dept);
+                path.push_back(dept);
+            } else {
+                company->add(*path.back(), std::make_shared<Employee>(nodeName));
+            }
+        }
+        return company;
+    }
+
+private:
+    // One pass over the node table, so display/export/toCompany can trust it: the root is a department at
+    // depth 0, every other node sits at 1..previous depth + 1 under a department, and each subtreeEnd
+    // matches where its subtree actually closes.
+    static bool validTree(const SnapshotNode* nodes, size_t count) {
+        if (nodes[0].depth != 0 || !nodes[0].isDepartment) {
+            return false;
+        }
+        std::vector<uint32_t> path = {0};  // open subtrees from the root down to the previous node
+        for (size_t i = 1; i < count; ++i) {
+            uint32_t depth = nodes[i].depth;
+            if (depth == 0 || depth > path.size()) {
+                return false;
+            }
+            for (; path.size() > depth; path.pop_back()) {
+                if (nodes[path.back()].subtreeEnd != i) {
+                    return false;
+                }
+            }
+            if (!nodes[path.back()].isDepartment) {
+                return false;
+            }
+            path.push_back(static_cast<uint32_t>(i));
+        }
+        for (; !path.empty(); path.pop_back()) {
+            if (nodes[path.back()].subtreeEnd != count) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char* data_ = nullptr;
+    size_t length_ = 0;
+    const SnapshotNode* nodes_ = nullptr;
+    const char* pool_ = nullptr;
+    size_t nodeCount_ = 0;
+    size_t poolSize_ = 0;
+};
 
-    auto nodes = parser.parse(std::cin, n);
-    builder.build(company, nodes);
-    company.display();
+// ==================== Benchmarks ====================
+
+// root -> departments x employees
+std::unique_ptr<Company> makeWideCompany(size_t departments, size_t employees) {
+    auto company = std::make_unique<Company>("Wide");
+    for (size_t d = 0; d < departments; ++d) {
+        auto dept = std::make_shared<Department>("D" + std::to_string(d));
+        for (size_t e = 0; e < employees; ++e) {
+            dept->add(std::make_shared<Employee>("E" + std::to_string(e)));
+        }
+        company->add(*company->getRoot(), dept);
+    }
+    return company;
+}
+
+// complete binary tree of departments, each holding a couple of employees
+std::unique_ptr<Company> makeDeepCompany(int levels) {
+    auto company = std::make_unique<Company>("Deep");
+    std::vector<std::shared_ptr<Department>> level = {company->getRoot()};
+    for (int depth = 0; depth < levels; ++depth) {
+        std::vector<std::shared_ptr<Department>> next;
+        for (auto& parent : level) {
+            for (int i = 0; i < 2; ++i) {
+                auto dept = std::make_shared<Department>("D" + std::to_string(depth));
+                dept->add(std::make_shared<Employee>("E" + std::to_string(depth)));
+                parent->add(dept);
+                next.push_back(dept);
+            }
+        }
+        level.swap(next);
+    }
+    return company;
+}
+
+template <typename Fn>
+double timeMs(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void benchmarkTraversal(const std::string& label, const Company& company, const std::string& needle) {
+    const Department& root = *company.getRoot();
+    root.getHeadcount();  // keep the one-off aggregate refresh out of the timings
+
+    std::ostringstream serial;
+    double serialMs = timeMs([&] {
+        TreeRenderer renderer(serial);
+        renderer.render(root, 0);
+    });
+    std::cout << label << ": " << root.getHeadcount() + root.getDepartmentCount() + 1 << " nodes, serial render "
+              << serialMs << " ms" << std::endl;
+
+    std::vector<const Component*> baseline;
+    for (size_t threads : {1, 2, 4, 8}) {
+        WorkStealingPool pool(threads);
+        std::string rendered;
+        std::vector<const Component*> found;
+        Totals totals;
+        double renderMs = timeMs([&] { rendered = renderParallel(pool, root); });
+        double findMs = timeMs([&] { found = findParallel(pool, root, needle); });
+        double totalsMs = timeMs([&] { totals = totalsParallel(pool, root); });
+        if (baseline.empty()) {
+            baseline = found;
+        }
+
+        bool same = rendered == serial.str() && found == baseline
+            && totals.employees == root.getHeadcount() && totals.departments == root.getDepartmentCount() + 1;
+        std::cout << "  threads " << threads << ": render " << renderMs << " ms, find " << findMs
+                  << " ms (" << found.size() << " hits), totals " << totalsMs << " ms"
+                  << (same ? "" : "  MISMATCH") << std::endl;
+    }
+}
+
+void benchmarkLoad(const std::string& label, const Company& company) {
+    const std::string snapshotPath = "/tmp/composite_bench.snap";
+    const std::string textPath = "/tmp/composite_bench.txt";
+    saveSnapshot(company, snapshotPath);
+    {
+        CompanySnapshot snapshot;
+        snapshot.open(snapshotPath);
+        std::ofstream text(textPath);
+        snapshot.exportText(text);
+    }
+
+    std::unique_ptr<Company> parsed;
+    double textMs = timeMs([&] {
+        std::ifstream input(textPath);
+        parsed = readCompany(input);
+    });
+
+    CompanySnapshot snapshot;
+    size_t checksum = 0;
+    double openMs = timeMs([&] { snapshot.open(snapshotPath); });
+    double scanMs = timeMs([&] {
+        for (size_t i = 0; i < snapshot.size(); ++i) {
+            checksum += snapshot.name(i).size();
+        }
+    });
+    std::unique_ptr<Company> materialized;
+    double buildMs = timeMs([&] { materialized = snapshot.toCompany(); });
+
+    std::ostringstream fromText, fromSnapshot;
+    {
+        TreeRenderer renderer(fromText);
+        renderer.render(*parsed->getRoot(), 0);
+    }
+    {
+        TreeRenderer renderer(fromSnapshot);
+        renderer.render(*materialized->getRoot(), 0);
+    }
+
+    std::cout << label << ": " << snapshot.size() << " nodes" << std::endl
+              << "  text parse + build   " << textMs << " ms" << std::endl
+              << "  snapshot open (mmap) " << openMs << " ms" << std::endl
+              << "  snapshot full scan   " << scanMs << " ms (" << checksum << " name bytes)" << std::endl
+              << "  snapshot -> Company  " << buildMs << " ms"
+              << (fromText.str() == fromSnapshot.str() ? "" : "  MISMATCH") << std::endl;
+
+    std::remove(snapshotPath.c_str());
+    std::remove(textPath.c_str());
+}
+
+int runBenchmarks() {
+    auto wide = makeWideCompany(1000, 1000);
+    auto deep = makeDeepCompany(19);
+    benchmarkTraversal("wide 1000x1000", *wide, "E42");
+    benchmarkTraversal("deep binary 2^19", *deep, "E18");
+    benchmarkLoad("wide 1000x1000", *wide);
+    benchmarkLoad("deep binary 2^19", *deep);
+    return 0;
+}
+
+// ==================== Entry ====================
+
+// usage: composite                          read the text format from stdin and display it
+//        composite --save-snapshot FILE     same, and also write a binary snapshot of the tree
+//        composite --load-snapshot FILE     display a snapshot instead of reading stdin
+//        composite --export-snapshot FILE   print a snapshot back in the text format
+//        composite --bench
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--bench") {
+        return runBenchmarks();
+    }
+
+    std::ios_base::sync_with_stdio(false);
+    std::cin.tie(NULL);
+
+    if ((mode == "--load-snapshot" || mode == "--export-snapshot") && argc > 2) {
+        CompanySnapshot snapshot;
+        if (!snapshot.open(argv[2])) {
+            std::cerr << "Invalid snapshot: " << argv[2] << std::endl;
+            return 1;
+        }
+        if (mode == "--load-snapshot") {
+            snapshot.display(std::cout);
+        } else {
+            snapshot.exportText(std::cout);
+        }
+        return 0;
+    }
+
+    auto company = readCompany(std::cin);
+    if (mode == "--save-snapshot" && argc > 2 && !saveSnapshot(*company, argv[2])) {
+        std::cerr << "Cannot write snapshot: " << argv[2] << std::endl;
+        return 1;
+    }
+    company->display();
 
     return 0;
 }
\ No newline at end of file
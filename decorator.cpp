@@ -6,22 +6,53 @@
  */
 
 
+#include <chrono>
 #include <iostream>
 #include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// one flattened brewing step: what a single layer prints
+using BrewStep = void (*)(std::ostream&);
 
 // component interface
 class Coffee {
 public:
     virtual void brew() const = 0;
     virtual ~Coffee() = default;
+
+    // writes this coffee's steps to out without flushing; brew() is brewTo(std::cout) plus one flush
+    virtual void brewTo(std::ostream& out) const = 0;
+
+    // flattening support: the coffee this layer wraps (null for a base) and the steps the layer itself adds
+    virtual const Coffee* wrapped() const {
+        return nullptr;
+    }
+    virtual void appendSteps(std::vector<BrewStep>& steps) const = 0;
 };
 
 
 // concrete component
 class BlackCoffee : public Coffee {
 public:
+    static void step(std::ostream& out) {
+        out << "Brewing Black Coffee\n";
+    }
+
+    void brewTo(std::ostream& out) const override {
+        step(out);
+    }
+
     void brew() const override {
-        std::cout << "Brewing Black Coffee" << std::endl;
+        step(std::cout);
+        std::cout.flush();
+    }
+
+    void appendSteps(std::vector<BrewStep>& steps) const override {
+        steps.push_back(&BlackCoffee::step);
     }
 };
 
@@ -29,8 +60,21 @@ public:
 // concrete component
 class Latte : public Coffee {
 public:
+    static void step(std::ostream& out) {
+        out << "Brewing Latte\n";
+    }
+
+    void brewTo(std::ostream& out) const override {
+        step(out);
+    }
+
     void brew() const override {
-        std::cout << "Brewing Latte" << std::endl;
+        step(std::cout);
+        std::cout.flush();
+    }
+
+    void appendSteps(std::vector<BrewStep>& steps) const override {
+        steps.push_back(&Latte::step);
     }
 };
 
@@ -45,6 +89,17 @@ public:
     void brew() const override {
         _coffee->brew();
     }
+
+    void brewTo(std::ostream& out) const override {
+        _coffee->brewTo(out);
+    }
+
+    const Coffee* wrapped() const override {
+        return _coffee.get();
+    }
+
+    // a bare decorator only forwards, it adds no step of its own
+    void appendSteps(std::vector<BrewStep>&) const override {}
 };
 
 
@@ -53,9 +108,23 @@ class MilkDecorator : public Decorator {
 public:
     MilkDecorator(std::unique_ptr<Coffee> coffee) : Decorator(std::move(coffee)) {}
 
+    static void step(std::ostream& out) {
+        out << "Adding Milk\n";
+    }
+
     void brew() const override {
         Decorator::brew();
-        std::cout << "Adding Milk" << std::endl;
+        step(std::cout);
+        std::cout.flush();
+    }
+
+    void brewTo(std::ostream& out) const override {
+        Decorator::brewTo(out);
+        step(out);
+    }
+
+    void appendSteps(std::vector<BrewStep>& steps) const override {
+        steps.push_back(&MilkDecorator::step);
     }
 };
 
@@ -65,16 +134,314 @@ class SugarDecorator : public Decorator {
 public:
     SugarDecorator(std::unique_ptr<Coffee> coffee) : Decorator(std::move(coffee)) {}
 
+    static void step(std::ostream& out) {
+        out << "Adding Sugar\n";
+    }
+
     void brew() const override {
         Decorator::brew();
-        std::cout << "Adding Sugar" << std::endl;
+        step(std::cout);
+        std::cout.flush();
+    }
+
+    void brewTo(std::ostream& out) const override {
+        Decorator::brewTo(out);
+        step(out);
+    }
+
+    void appendSteps(std::vector<BrewStep>& steps) const override {
+        steps.push_back(&SugarDecorator::step);
     }
 };
 
 
-int main() {
+// Compile-time decorators. Sugar<Milk<BlackCoffee>> is one object: each layer calls Base::brewTo() without
+// virtual dispatch, so the whole stack inlines into a single brew() that flushes once at the end. They are
+// still Coffees, so runtime decorators can wrap them, and Milk<Decorator> (or Milk<SugarDecorator>) puts a
+// static layer on top of a runtime chain through the inherited constructor.
+template <typename Base>
+class Milk : public Base {
+public:
+    using Base::Base;
+
+    void brewTo(std::ostream& out) const override {
+        Base::brewTo(out);
+        MilkDecorator::step(out);
+    }
+
+    void brew() const override {
+        Milk::brewTo(std::cout);
+        std::cout.flush();
+    }
+
+    void appendSteps(std::vector<BrewStep>& steps) const override {
+        Base::appendSteps(steps);
+        steps.push_back(&MilkDecorator::step);
+    }
+};
+
+
+template <typename Base>
+class Sugar : public Base {
+public:
+    using Base::Base;
+
+    void brewTo(std::ostream& out) const override {
+        Base::brewTo(out);
+        SugarDecorator::step(out);
+    }
+
+    void brew() const override {
+        Sugar::brewTo(std::cout);
+        std::cout.flush();
+    }
+
+    void appendSteps(std::vector<BrewStep>& steps) const override {
+        Base::appendSteps(steps);
+        steps.push_back(&SugarDecorator::step);
+    }
+};
+
+
+// A decorator stack flattened into one contiguous array of steps. Built once by walking the chain
+// iteratively, then run() is a tight loop instead of a recursive brew() through every layer.
+class BrewPipeline {
+public:
+    BrewPipeline(const Coffee& coffee) {
+        std::vector<const Coffee*> layers;
+        for (const Coffee* layer = &coffee; layer != nullptr; layer = layer->wrapped()) {
+            layers.push_back(layer);
+        }
+        // innermost layer brews first
+        for (auto it = layers.rbegin(); it != layers.rend(); ++it) {
+            (*it)->appendSteps(_steps);
+        }
+    }
+
+    // prints exactly what brew() prints, flushing once at the end instead of once per layer
+    void run(std::ostream& out = std::cout) const {
+        for (BrewStep step : _steps) {
+            step(out);
+        }
+        out.flush();
+    }
+
+    size_t size() const {
+        return _steps.size();
+    }
+
+private:
+    std::vector<BrewStep> _steps;
+};
+
+
+enum CoffeeBase {
+    BLACK_COFFEE, LATTE
+};
+
+enum Topping {
+    MILK, SUGAR
+};
+
+
+// Hash-consing cache: one shared, immutable decorated coffee per base + topping sequence, with its brew
+// output rendered once. A repeated order costs a hash lookup instead of building and walking the chain.
+class CoffeeCache {
+public:
+    struct Entry {
+        std::shared_ptr<const Coffee> coffee;
+        std::string output;  // exactly what coffee->brew() prints
+    };
+
+    // entries live as long as the cache; the returned reference stays valid across later insertions
+    const Entry& get(CoffeeBase base, const std::vector<Topping>& toppings) {
+        _key.clear();
+        _key += static_cast<char>('0' + base);
+        for (Topping topping : toppings) {
+            _key += static_cast<char>('0' + topping);
+        }
+
+        auto it = _entries.find(_key);
+        if (it != _entries.end()) {
+            ++_hits;
+            return it->second;
+        }
+        ++_misses;
+
+        std::shared_ptr<const Coffee> coffee = build(base, toppings);
+        std::ostringstream rendered;
+        BrewPipeline(*coffee).run(rendered);
+        return _entries.emplace(_key, Entry{std::move(coffee), rendered.str()}).first->second;
+    }
+
+    size_t hits() const {
+        return _hits;
+    }
+
+    size_t misses() const {
+        return _misses;
+    }
+
+    size_t size() const {
+        return _entries.size();
+    }
+
+private:
+    static std::unique_ptr<Coffee> build(CoffeeBase base, const std::vector<Topping>& toppings) {
+        std::unique_ptr<Coffee> coffee;
+        if (base == BLACK_COFFEE) {
+            coffee = std::make_unique<BlackCoffee>();
+        } else {
+            coffee = std::make_unique<Latte>();
+        }
+        for (Topping topping : toppings) {
+            if (topping == MILK) {
+                coffee = std::make_unique<MilkDecorator>(std::move(coffee));
+            } else {
+                coffee = std::make_unique<SugarDecorator>(std::move(coffee));
+            }
+        }
+        return coffee;
+    }
+
+    std::unordered_map<std::string, Entry> _entries;
+    std::string _key;  // reused between lookups so a hit does not allocate
+    size_t _hits = 0;
+    size_t _misses = 0;
+};
+
+
+// swallows everything, so benchmarks measure dispatch rather than the terminal
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize n) override {
+        return n;
+    }
+};
+
+
+std::unique_ptr<Coffee> makeLayeredCoffee(int layers) {
+    std::unique_ptr<Coffee> coffee = std::make_unique<BlackCoffee>();
+    for (int i = 0; i < layers; ++i) {
+        if (i % 2 == 0) {
+            coffee = std::make_unique<MilkDecorator>(std::move(coffee));
+        } else {
+            coffee = std::make_unique<SugarDecorator>(std::move(coffee));
+        }
+    }
+    return coffee;
+}
+
+template <typename Fn>
+double timeNsPerBrew(int iterations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+int runBenchmarks() {
+    NullBuffer sink;
+    std::ostream results(std::cout.rdbuf());
+    std::streambuf* terminal = std::cout.rdbuf(&sink);
+
+    for (int layers : {1, 1000}) {
+        auto coffee = makeLayeredCoffee(layers);
+        BrewPipeline pipeline(*coffee);
+        int iterations = layers == 1 ? 1000000 : 2000;
+
+        double chained = timeNsPerBrew(iterations, [&] { coffee->brew(); });
+        double flattened = timeNsPerBrew(iterations, [&] { pipeline.run(std::cout); });
+        results << layers << " layers: decorator chain " << chained << " ns/brew, flattened "
+                << flattened << " ns/brew" << std::endl;
+    }
+
+    // static mixins against the equivalent runtime chain, both called through a Coffee reference
+    {
+        using StaticTwo = Sugar<Milk<BlackCoffee>>;
+        using StaticEight = Sugar<Milk<Sugar<Milk<Sugar<Milk<Sugar<Milk<BlackCoffee>>>>>>>>;
+        std::unique_ptr<Coffee> staticTwo = std::make_unique<StaticTwo>();
+        std::unique_ptr<Coffee> staticEight = std::make_unique<StaticEight>();
+        std::unique_ptr<Coffee> runtimeTwo = makeLayeredCoffee(2);
+        std::unique_ptr<Coffee> runtimeEight = makeLayeredCoffee(8);
+        // a static layer over a runtime chain brews the same thing
+        Milk<Decorator> mixed(makeLayeredCoffee(1));
+
+        int iterations = 1000000;
+        double virtualTwo = timeNsPerBrew(iterations, [&] { runtimeTwo->brew(); });
+        double inlinedTwo = timeNsPerBrew(iterations, [&] { staticTwo->brew(); });
+        double virtualEight = timeNsPerBrew(iterations, [&] { runtimeEight->brew(); });
+        double inlinedEight = timeNsPerBrew(iterations, [&] { staticEight->brew(); });
+        double mixedTwo = timeNsPerBrew(iterations, [&] { mixed.brew(); });
+        results << "2 layers: virtual " << virtualTwo << " ns/brew, static " << inlinedTwo
+                << " ns/brew, static over runtime " << mixedTwo << " ns/brew" << std::endl;
+        results << "8 layers: virtual " << virtualEight << " ns/brew, static " << inlinedEight << " ns/brew"
+                << std::endl;
+    }
+
+    // repeated orders drawn from the four single-topping combinations main serves
+    std::mt19937 random(42);
+    std::vector<int> orders(1000000);
+    for (int& order : orders) {
+        order = static_cast<int>(random() % 4);
+    }
+    CoffeeCache cache;
+    std::vector<Topping> toppings(1);
+    size_t next = 0;
+    double rebuilt = timeNsPerBrew(orders.size(), [&] {
+        int order = orders[next++ % orders.size()];
+        std::unique_ptr<Coffee> coffee;
+        if (order / 2 == 0) {
+            coffee = std::make_unique<BlackCoffee>();
+        } else {
+            coffee = std::make_unique<Latte>();
+        }
+        if (order % 2 == 0) {
+            coffee = std::make_unique<MilkDecorator>(std::move(coffee));
+        } else {
+            coffee = std::make_unique<SugarDecorator>(std::move(coffee));
+        }
+        coffee->brew();
+    });
+    double cached = timeNsPerBrew(orders.size(), [&] {
+        int order = orders[next++ % orders.size()];
+        toppings[0] = order % 2 == 0 ? MILK : SUGAR;
+        std::cout << cache.get(order / 2 == 0 ? BLACK_COFFEE : LATTE, toppings).output << std::flush;
+    });
+    results << "repeated orders: rebuilt " << rebuilt << " ns/order, cached " << cached << " ns/order ("
+            << cache.hits() << " hits, " << cache.misses() << " misses)" << std::endl;
+
+    std::cout.rdbuf(terminal);
+    return 0;
+}
+
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--bench") {
+        return runBenchmarks();
+    }
+    // default serves repeated orders from the cache; --chain builds and brews the decorator chain per order,
+    // --flat does the same through a BrewPipeline
+    bool chain = mode == "--chain";
+    bool flatten = mode == "--flat";
+
+    CoffeeCache cache;
+    std::vector<Topping> toppings;
     int type, add;
     while (std::cin >> type >> add) {
+        if (!chain && !flatten) {
+            toppings.assign(1, add == 1 ? MILK : SUGAR);
+            std::cout << cache.get(type == 1 ? BLACK_COFFEE : LATTE, toppings).output << std::flush;
+            continue;
+        }
+
         std::unique_ptr<Coffee> coffee;
         if (type == 1) {
             coffee = std::make_unique<BlackCoffee>();
@@ -94,6 +461,10 @@ int main() {
         // coffee = std::make_unique<MilkDecorator>(std::move(coffee));
         // coffee = std::make_unique<SugarDecorator>(std::move(coffee));
 
-        coffee->brew();
+        if (flatten) {
+            BrewPipeline(*coffee).run();
+        } else {
+            coffee->brew();
+        }
     }
 }
\ No newline at end of file
@@ -7,14 +7,35 @@
  */
 
  #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 class Appliance {
 public:
     virtual std::string getName() const {
         return this->_name;
     }
+    // the device-side part of turning off / on; returns whether the device confirmed
+    virtual bool switchOff() const {
+        return true;
+    }
+    virtual bool switchOn() const {
+        return true;
+    }
     virtual void turnOff() const {
+        switchOff();
         std::cout << this->getName() << " is turned off." << std::endl;
     }
     virtual ~Appliance() = default;
@@ -45,58 +66,580 @@ public:
 };
 
 
+// fixed-size pool of workers pulling from one queue
+class ThreadPool {
+public:
+    ThreadPool(size_t workers) {
+        for (size_t i = 0; i < workers; ++i) {
+            _threads.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    size_t size() const {
+        return _threads.size();
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.push(std::move(task));
+        }
+        _wake.notify_one();
+    }
+
+    // run body(begin, end) over [0, count) in a few chunks per worker and block until all are done
+    void parallelFor(size_t count, const std::function<void(size_t, size_t)>& body) {
+        size_t chunks = std::min(count, _threads.size() * 4);
+        if (chunks == 0) {
+            return;
+        }
+        std::mutex doneMutex;
+        std::condition_variable doneSignal;
+        size_t remaining = chunks;
+
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            size_t begin = count * chunk / chunks;
+            size_t end = count * (chunk + 1) / chunks;
+            submit([&, begin, end] {
+                body(begin, end);
+                std::lock_guard<std::mutex> lock(doneMutex);
+                if (--remaining == 0) {
+                    doneSignal.notify_one();
+                }
+            });
+        }
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneSignal.wait(lock, [&] { return remaining == 0; });
+    }
+
+private:
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+                if (_tasks.empty()) {
+                    return;
+                }
+                task = std::move(_tasks.front());
+                _tasks.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> _threads;
+    std::queue<std::function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    bool _stopping = false;
+};
+
+
+// runs callbacks at their deadlines on one background thread
+class DeadlineTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    DeadlineTimer() : _thread([this] { timerLoop(); }) {}
+
+    ~DeadlineTimer() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_one();
+        _thread.join();  // deadlines still pending are dropped
+    }
+
+    void schedule(Clock::time_point deadline, std::function<void()> callback) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _deadlines.push({deadline, std::move(callback)});
+        }
+        _wake.notify_one();
+    }
+
+private:
+    struct Deadline {
+        Clock::time_point when;
+        std::function<void()> callback;
+
+        bool operator>(const Deadline& other) const {
+            return when > other.when;
+        }
+    };
+
+    void timerLoop() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (!_stopping) {
+            if (_deadlines.empty()) {
+                _wake.wait(lock);
+                continue;
+            }
+            if (Clock::now() < _deadlines.top().when) {
+                _wake.wait_until(lock, _deadlines.top().when);
+                continue;
+            }
+            std::function<void()> callback = _deadlines.top().callback;
+            _deadlines.pop();
+            lock.unlock();
+            callback();
+            lock.lock();
+        }
+    }
+
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> _deadlines;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    bool _stopping = false;
+    std::thread _thread;
+};
+
+
+enum CommandStatus {
+    CONFIRMED, REJECTED, TIMED_OUT
+};
+
+// outcome of a group-wide operation
+struct GroupResult {
+    size_t succeeded = 0;       // devices whose state changed and confirmed it
+    size_t unchanged = 0;       // devices already in the requested state, not called at all
+    std::vector<int> failed;    // device codes that did not confirm and kept their old state
+    std::vector<int> timedOut;  // async only: device codes that missed the deadline
+};
+
 
+// Device on/off state lives in a dense bitset indexed by device code, and every group keeps a membership
+// bitset over the same codes. Bulk operations and queries are word-wide AND/ANDNOT/popcount, and only
+// devices whose bit actually flips are called back, so a no-op "all off" costs O(devices / 64).
 class FacadeControl {
 public:
-    void setAC(std::unique_ptr<Appliance> ac) {
-        _ac = std::move(ac);
+    static constexpr const char* ALL = "all";  // every registered device is also in this group
+
+    FacadeControl(size_t workers = std::max(1u, std::thread::hardware_concurrency())) : _pool(workers) {}
+
+    // register a device under a group; returns its device code, starting at 1 in registration order.
+    // Devices start out on.
+    int addAppliance(std::unique_ptr<Appliance> appliance, const std::string& group = ALL) {
+        _appliances.push_back(std::move(appliance));
+        int code = static_cast<int>(_appliances.size());
+        std::lock_guard<std::mutex> lock(_stateMutex);
+        setBit(_on, code);
+        setBit(_groups[ALL], code);
+        if (group != ALL) {
+            setBit(_groups[group], code);
+        }
+        return code;
+    }
+
+    size_t size() const {
+        return _appliances.size();
+    }
+
+    bool isOn(int code) const {
+        std::lock_guard<std::mutex> lock(_stateMutex);
+        return testBit(_on, code);
+    }
+
+    size_t countOn(const std::string& group) const {
+        size_t count = 0;
+        std::lock_guard<std::mutex> lock(_stateMutex);
+        forEachWord(group, [&](size_t word, uint64_t members) {
+            count += __builtin_popcountll(_on[word] & members);
+        });
+        return count;
+    }
+
+    // device codes of the group that are still on, ascending
+    std::vector<int> devicesOn(const std::string& group) const {
+        std::vector<int> codes;
+        std::lock_guard<std::mutex> lock(_stateMutex);
+        forEachWord(group, [&](size_t word, uint64_t members) {
+            appendCodes(codes, word, _on[word] & members);
+        });
+        return codes;
+    }
+
+    GroupResult turnOffGroup(const std::string& group) {
+        return switchGroup(group, false);
     }
 
-    void setLamp(std::unique_ptr<Appliance> lamp) {
-        _lamp = std::move(lamp);
+    GroupResult turnOnGroup(const std::string& group) {
+        return switchGroup(group, true);
     }
 
-    void setTV(std::unique_ptr<Appliance> tv) {
-        _tv = std::move(tv);
+    // ---- asynchronous commands ----
+    // Device calls run on a dedicated I/O pool, so slow devices overlap instead of adding up, and each call
+    // settles no later than its timeout: TIMED_OUT is reported at the deadline even if the device never answers.
+    // The state bits record the commanded state right away; a rejection puts the bit back, a late answer does
+    // not change it. Settling happens on worker and timer threads, so the bits are guarded by _stateMutex.
+
+    using Completion = std::function<void(int code, CommandStatus status)>;
+
+    std::future<CommandStatus> turnOffAsync(int code, std::chrono::milliseconds timeout, Completion done = nullptr) {
+        if (code < 1 || code > static_cast<int>(_appliances.size())) {
+            std::promise<CommandStatus> invalid;
+            invalid.set_value(REJECTED);
+            return invalid.get_future();
+        }
+        {
+            std::lock_guard<std::mutex> lock(_stateMutex);
+            clearBit(_on, code);
+        }
+        auto command = std::make_shared<PendingCommand>(code, std::move(done));
+        issue(command, timeout);
+        return command->promise.get_future();
+    }
+
+    // only devices whose bit flips are commanded; the future resolves once every one of them has settled
+    std::future<GroupResult> turnOffGroupAsync(const std::string& group, std::chrono::milliseconds timeout) {
+        auto tally = std::make_shared<GroupTally>();
+        std::vector<int> changed;
+        {
+            std::lock_guard<std::mutex> lock(_stateMutex);
+            forEachWord(group, [&](size_t word, uint64_t members) {
+                uint64_t flipping = _on[word] & members;
+                tally->result.unchanged += __builtin_popcountll(members & ~flipping);
+                appendCodes(changed, word, flipping);
+                _on[word] &= ~flipping;
+            });
+        }
+
+        std::future<GroupResult> future = tally->promise.get_future();
+        tally->remaining = changed.size();
+        if (changed.empty()) {
+            tally->promise.set_value(tally->result);
+            return future;
+        }
+        for (int code : changed) {
+            issue(std::make_shared<PendingCommand>(code, [tally](int device, CommandStatus status) {
+                std::lock_guard<std::mutex> lock(tally->mutex);
+                if (status == CONFIRMED) {
+                    tally->result.succeeded++;
+                } else if (status == REJECTED) {
+                    tally->result.failed.push_back(device);
+                } else {
+                    tally->result.timedOut.push_back(device);
+                }
+                if (--tally->remaining == 0) {
+                    tally->promise.set_value(std::move(tally->result));
+                }
+            }), timeout);
+        }
+        return future;
     }
 
+    // device codes 1..size() pick one device, size() + 1 turns everything off (4 with the classic three)
     void turnOffDevice(int choice) {
-        switch (choice) {
-            case 1:
-                _ac->turnOff();
-                break;
-            case 2:
-                _lamp->turnOff();
-                break;
-            case 3:
-                _tv->turnOff();
-                break;
-            case 4:  // turn off all devices
-                _ac->turnOff();
-                _lamp->turnOff();
-                _tv->turnOff();
-                std::cout << "All devices are off." << std::endl;
-                break;
-            default:
-                std::cout << "Invalid device code." << std::endl;      
+        int count = static_cast<int>(_appliances.size());
+        if (choice >= 1 && choice <= count) {
+            _appliances[choice - 1]->turnOff();
+            std::lock_guard<std::mutex> lock(_stateMutex);
+            clearBit(_on, choice);
+        } else if (choice == count + 1) {
+            turnOffGroup(ALL);
+            for (int code = 1; code <= count; ++code) {
+                if (!isOn(code)) {
+                    std::cout << _appliances[code - 1]->getName() << " is turned off." << std::endl;
+                }
+            }
+            std::cout << "All devices are off." << std::endl;
+        } else {
+            std::cout << "Invalid device code." << std::endl;
+        }
+    }
+
+private:
+    using Bitset = std::vector<uint64_t>;
+
+    static constexpr size_t PARALLEL_THRESHOLD = 256;  // below this the fan-out costs more than it saves
+
+    // code 1 is bit 0
+    static void setBit(Bitset& bits, int code) {
+        size_t bit = static_cast<size_t>(code - 1);
+        if (bits.size() <= bit / 64) {
+            bits.resize(bit / 64 + 1, 0);
+        }
+        bits[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+
+    static void clearBit(Bitset& bits, int code) {
+        size_t bit = static_cast<size_t>(code - 1);
+        if (bit / 64 < bits.size()) {
+            bits[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+        }
+    }
+
+    static bool testBit(const Bitset& bits, int code) {
+        size_t bit = static_cast<size_t>(code - 1);
+        return bit / 64 < bits.size() && (bits[bit / 64] >> (bit % 64) & 1);
+    }
+
+    static void appendCodes(std::vector<int>& codes, size_t word, uint64_t bits) {
+        while (bits != 0) {
+            codes.push_back(static_cast<int>(word * 64 + __builtin_ctzll(bits)) + 1);
+            bits &= bits - 1;
+        }
+    }
+
+    // a group's membership never extends past _on, which covers every registered code
+    template <typename Fn>
+    void forEachWord(const std::string& group, Fn&& fn) const {
+        auto it = _groups.find(group);
+        if (it == _groups.end()) {
+            return;
+        }
+        const Bitset& members = it->second;
+        for (size_t word = 0; word < members.size(); ++word) {
+            fn(word, members[word]);
+        }
+    }
+
+    GroupResult switchGroup(const std::string& group, bool on) {
+        GroupResult result;
+        std::vector<int> changed;
+        {
+            std::lock_guard<std::mutex> lock(_stateMutex);
+            forEachWord(group, [&](size_t word, uint64_t members) {
+                uint64_t flipping = (on ? ~_on[word] : _on[word]) & members;
+                result.unchanged += __builtin_popcountll(members & ~flipping);
+                appendCodes(changed, word, flipping);
+                _on[word] ^= flipping;
+            });
+        }
+
+        std::vector<char> confirmed(changed.size());
+        auto body = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Appliance& appliance = *_appliances[changed[i] - 1];
+                confirmed[i] = on ? appliance.switchOn() : appliance.switchOff();
+            }
+        };
+        if (changed.size() < PARALLEL_THRESHOLD) {
+            body(0, changed.size());
+        } else {
+            _pool.parallelFor(changed.size(), body);
+        }
+
+        std::lock_guard<std::mutex> lock(_stateMutex);
+        for (size_t i = 0; i < changed.size(); ++i) {
+            if (confirmed[i]) {
+                result.succeeded++;
+            } else {
+                result.failed.push_back(changed[i]);
+                if (on) {
+                    clearBit(_on, changed[i]);
+                } else {
+                    setBit(_on, changed[i]);
+                }
+            }
+        }
+        return result;
+    }
+
+    // settled exactly once, by whichever comes first: the device's answer or the deadline
+    struct PendingCommand {
+        PendingCommand(int code, Completion done) : code(code), done(std::move(done)) {}
+
+        void settle(CommandStatus status) {
+            if (claim()) {
+                finish(status);
+            }
+        }
+
+        // true for the one caller that gets to settle; it must then call finish()
+        bool claim() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (settled) {
+                return false;
+            }
+            settled = true;
+            return true;
+        }
+
+        void finish(CommandStatus status) {
+            if (done) {
+                done(code, status);  // before the future wakes, so waiters see the callback's effects
+            }
+            promise.set_value(status);
+        }
+
+        int code;
+        Completion done;
+        std::promise<CommandStatus> promise;
+        std::mutex mutex;
+        bool settled = false;
+    };
+
+    struct GroupTally {
+        std::mutex mutex;
+        size_t remaining = 0;
+        GroupResult result;
+        std::promise<GroupResult> promise;
+    };
+
+    void issue(const std::shared_ptr<PendingCommand>& command, std::chrono::milliseconds timeout) {
+        if (!_ioPool) {
+            _ioPool = std::make_unique<ThreadPool>(IO_THREADS);
+            _timer = std::make_unique<DeadlineTimer>();
+        }
+        _timer->schedule(DeadlineTimer::Clock::now() + timeout, [command] { command->settle(TIMED_OUT); });
+        const Appliance* appliance = _appliances[command->code - 1].get();
+        _ioPool->submit([this, command, appliance] {
+            bool confirmed = appliance->switchOff();
+            if (!command->claim()) {
+                return;  // the deadline got there first
+            }
+            if (!confirmed) {
+                // the device kept its old state, so its bit goes back before anyone is told
+                std::lock_guard<std::mutex> lock(_stateMutex);
+                setBit(_on, command->code);
+            }
+            command->finish(confirmed ? CONFIRMED : REJECTED);
+        });
+    }
+
+    static constexpr size_t IO_THREADS = 64;  // device calls mostly wait, so this is not tied to the core count
+
+    std::vector<std::unique_ptr<Appliance>> _appliances;
+    Bitset _on;
+    mutable std::mutex _stateMutex;  // guards _on against async commands settling on other threads
+    std::unordered_map<std::string, Bitset> _groups;  // group -> membership
+    ThreadPool _pool;
+    // created on first async call; declared last so they stop before the appliances they reference go away
+    std::unique_ptr<DeadlineTimer> _timer;
+    std::unique_ptr<ThreadPool> _ioPool;
+};
+
+
+// stand-in for a real device: switching off burns a fixed amount of CPU
+class SimulatedAppliance : public Appliance {
+public:
+    SimulatedAppliance(int id, int work) : Appliance("Device " + std::to_string(id)), _work(work) {}
+
+    bool switchOff() const override {
+        volatile int sink = 0;
+        for (int i = 0; i < _work; ++i) {
+            sink = sink + i;
         }
+        return true;
+    }
+
+private:
+    int _work;
+};
+
+
+// stand-in for a networked device: every command takes a fixed time to answer
+class LatencyAppliance : public Appliance {
+public:
+    LatencyAppliance(int id, std::chrono::milliseconds latency)
+        : Appliance("Remote " + std::to_string(id)), _latency(latency) {}
+
+    bool switchOff() const override {
+        std::this_thread::sleep_for(_latency);
+        return true;
     }
 
 private:
-    std::unique_ptr<Appliance> _ac;
-    std::unique_ptr<Appliance> _lamp;
-    std::unique_ptr<Appliance> _tv;
+    std::chrono::milliseconds _latency;
 };
 
 
-int main() {
+// simulated-latency checks of the async API: overlap, per-call timeout, and completion callbacks
+int runAsyncChecks() {
+    using namespace std::chrono;
+    auto ms = [](auto from, auto to) {
+        return duration<double, std::milli>(to - from).count();
+    };
+    bool ok = true;
+
+    FacadeControl fc;
+    for (int i = 0; i < 32; ++i) {
+        fc.addAppliance(std::make_unique<LatencyAppliance>(i, milliseconds(20)), "remote");
+    }
+    int slow = fc.addAppliance(std::make_unique<LatencyAppliance>(99, milliseconds(400)), "slow");
+
+    auto start = steady_clock::now();
+    GroupResult group = fc.turnOffGroupAsync("remote", milliseconds(200)).get();
+    auto groupDone = steady_clock::now();
+    std::cout << "32 devices x 20 ms: async group off " << ms(start, groupDone) << " ms (sequential would be ~640 ms), "
+              << group.succeeded << " confirmed" << std::endl;
+    ok = ok && group.succeeded == 32 && ms(start, groupDone) < 320;
+
+    std::atomic<int> callbackStatus{-1};
+    auto future = fc.turnOffAsync(slow, milliseconds(50), [&](int, CommandStatus status) {
+        callbackStatus = status;
+    });
+    CommandStatus status = future.get();
+    auto timedOut = steady_clock::now();
+    std::cout << "400 ms device, 50 ms timeout: settled after " << ms(groupDone, timedOut) << " ms as "
+              << (status == TIMED_OUT ? "TIMED_OUT" : "not timed out") << std::endl;
+    ok = ok && status == TIMED_OUT && callbackStatus == TIMED_OUT && ms(groupDone, timedOut) < 200;
+
+    std::cout << (ok ? "async checks passed" : "async checks FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
+
+
+int runBenchmarks() {
+    for (size_t devices : {16, 256, 4096, 65536}) {
+        FacadeControl fc;
+        std::vector<std::unique_ptr<Appliance>> sequential;
+        for (size_t i = 0; i < devices; ++i) {
+            fc.addAppliance(std::make_unique<SimulatedAppliance>(i, 2000));
+            sequential.push_back(std::make_unique<SimulatedAppliance>(i, 2000));
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (auto& appliance : sequential) {
+            appliance->switchOff();
+        }
+        auto middle = std::chrono::steady_clock::now();
+        GroupResult result = fc.turnOffGroup(FacadeControl::ALL);
+        auto end = std::chrono::steady_clock::now();
+        GroupResult repeat = fc.turnOffGroup(FacadeControl::ALL);  // everything is off already
+        auto noop = std::chrono::steady_clock::now();
+        size_t stillOn = fc.countOn(FacadeControl::ALL);
+        auto query = std::chrono::steady_clock::now();
+
+        auto ms = [](auto from, auto to) {
+            return std::chrono::duration<double, std::milli>(to - from).count();
+        };
+        std::cout << devices << " devices: sequential " << ms(start, middle) << " ms, facade fan-out "
+                  << ms(middle, end) << " ms (" << result.succeeded << " ok), no-op all off " << ms(end, noop)
+                  << " ms (" << repeat.unchanged << " unchanged), count on " << ms(noop, query) << " ms ("
+                  << stillOn << ")" << std::endl;
+    }
+    return runAsyncChecks();
+}
+
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return runBenchmarks();
+    }
+
     int N, n;
     std::cin >> N;
 
     FacadeControl fc;
-    fc.setAC(std::make_unique<AC>());
-    fc.setLamp(std::make_unique<Lamp>());
-    fc.setTV(std::make_unique<Television>());
+    fc.addAppliance(std::make_unique<AC>());
+    fc.addAppliance(std::make_unique<Lamp>());
+    fc.addAppliance(std::make_unique<Television>());
 
     while (N--) {
         std::cin >> n;
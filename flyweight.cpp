@@ -9,17 +9,31 @@
  */
 
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cstdint>
 #include <iostream>
-#include <unordered_map>
+#include <list>
+#include <mutex>
+#include <random>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <thread>
+#include <vector>
 
 
 enum ShapeType {
     CIRCLE, RECTANGLE, TRIANGLE
 };
 
+constexpr size_t SHAPE_TYPE_COUNT = TRIANGLE + 1;
+
 std::string shapeTypeToString(ShapeType type) {
     switch (type) {
         case CIRCLE:
@@ -34,9 +48,77 @@ std::string shapeTypeToString(ShapeType type) {
 }
 
 
+// shape names differ in length, so the length alone picks the only candidate to compare against
+bool parseShapeType(std::string_view name, ShapeType& type) {
+    switch (name.size()) {
+        case 6:
+            type = CIRCLE;
+            return name == "CIRCLE";
+        case 9:
+            type = RECTANGLE;
+            return name == "RECTANGLE";
+        case 8:
+            type = TRIANGLE;
+            return name == "TRIANGLE";
+        default:
+            return false;
+    }
+}
+
+void appendInt(std::string& out, int value) {
+    char digits[16];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// characters needed to print value, sign included. Branch-free so loops over it vectorize.
+inline size_t decimalWidth(int value) {
+    uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+    return (value < 0) + 1 + (magnitude >= 10) + (magnitude >= 100) + (magnitude >= 1000) + (magnitude >= 10000)
+         + (magnitude >= 100000) + (magnitude >= 1000000) + (magnitude >= 10000000) + (magnitude >= 100000000)
+         + (magnitude >= 1000000000);
+}
+
+// writes value into exactly decimalWidth(value) characters ending at end, two digits per step
+inline void writeDecimal(char* end, int value) {
+    static constexpr char PAIRS[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value);
+    while (magnitude >= 100) {
+        uint32_t pair = (magnitude % 100) * 2;
+        magnitude /= 100;
+        *--end = PAIRS[pair + 1];
+        *--end = PAIRS[pair];
+    }
+    if (magnitude >= 10) {
+        *--end = PAIRS[magnitude * 2 + 1];
+        *--end = PAIRS[magnitude * 2];
+    } else {
+        *--end = static_cast<char>('0' + magnitude);
+    }
+    if (value < 0) {
+        *--end = '-';
+    }
+}
+
+
 class IShape {
 public:
     virtual std::string draw(int x, int y) = 0;
+    // same text as draw(), appended to a caller-owned buffer
+    virtual void drawTo(int x, int y, std::string& out) {
+        out += draw(x, y);
+    }
+    // count placements in one call, extrinsic state passed as parallel coordinate arrays;
+    // each line is prefix followed by what drawTo() writes
+    virtual void drawBatch(std::string_view prefix, const int* xs, const int* ys, size_t count, std::string& out) {
+        for (size_t i = 0; i < count; ++i) {
+            out += prefix;
+            drawTo(xs[i], ys[i], out);
+        }
+    }
     virtual ~IShape() = default;
 };
 
@@ -51,32 +133,164 @@ public:
         return oss.str();  // concatenate result string in the proccessCommand method later
     } 
 
+    void drawTo(int x, int y, std::string& out) override {
+        out += "at (";
+        appendInt(out, x);
+        out += ", ";
+        appendInt(out, y);
+        out += ")\n";
+    }
+
+    // one sizing pass over the coordinate columns, a single resize, then every line is written in place
+    void drawBatch(std::string_view prefix, const int* xs, const int* ys, size_t count, std::string& out) override {
+        const size_t fixed = prefix.size() + sizeof("at (, )\n") - 1;
+        size_t total = count * fixed;
+        for (size_t i = 0; i < count; ++i) {
+            total += decimalWidth(xs[i]) + decimalWidth(ys[i]);
+        }
+
+        size_t offset = out.size();
+        out.resize(offset + total);
+        char* cursor = &out[offset];
+        for (size_t i = 0; i < count; ++i) {
+            cursor = std::copy(prefix.begin(), prefix.end(), cursor);
+            cursor = std::copy_n("at (", 4, cursor);
+            cursor += decimalWidth(xs[i]);
+            writeDecimal(cursor, xs[i]);
+            cursor = std::copy_n(", ", 2, cursor);
+            cursor += decimalWidth(ys[i]);
+            writeDecimal(cursor, ys[i]);
+            cursor = std::copy_n(")\n", 2, cursor);
+        }
+    }
+
 private:
     // DO NOT record whether a shaped is created or not. Leave it to factory.
     ShapeType _type;
 };
 
 
+// what the factory has saved so far
+struct FactoryStats {
+    size_t hits = 0;        // requests answered with an existing flyweight
+    size_t misses = 0;      // requests that had to create one
+    size_t live = 0;        // flyweights currently alive
+    size_t bytesSaved = 0;  // estimate vs. one object per request: (requests - misses) * bytes per instance
+};
+
+
+// Safe to share between threads. By default a flyweight is created once and then never replaced, so lookups
+// of existing ones are a single acquire load of its published flag, with no lock. Only the first request for
+// a type takes the mutex, and the re-check under it guarantees exactly one caller sees shared == false.
+//
+// With a capacity, the factory pins only the `capacity` most recently used flyweights and holds the rest
+// weakly: once no client holds an evicted flyweight it is freed, and the next request recreates it. The
+// bounded mode serializes lookups on the mutex.
 class ShapeFactory {
 public:
+    ShapeFactory(size_t capacity = 0) : _capacity(capacity) {}
+
     std::pair<std::shared_ptr<IShape>, bool> getShape(ShapeType type) {
-        bool shared = true;
-        if (shapes.find(type) == shapes.end()) {
-            shapes[type] = std::make_shared<Shape>(type);
-            shared = false;
+        if (_capacity > 0) {
+            return getBounded(type);
+        }
+        if (_published[type].load(std::memory_order_acquire)) {
+            count(true);
+            return {_shapes[type], true};
+        }
+
+        std::lock_guard<std::mutex> lock(_creating);
+        bool shared = _published[type].load(std::memory_order_relaxed);
+        if (!shared) {
+            _shapes[type] = std::make_shared<Shape>(type);
+            _published[type].store(true, std::memory_order_release);
         }
-        return {shapes[type], shared};
+        count(shared);
+        return {_shapes[type], shared};
+    }
+
+    FactoryStats stats() {
+        FactoryStats stats;
+        for (const auto& stripe : _stripes) {
+            stats.hits += stripe.hits.load(std::memory_order_relaxed);
+            stats.misses += stripe.misses.load(std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> lock(_creating);
+        for (size_t type = 0; type < SHAPE_TYPE_COUNT; ++type) {
+            stats.live += _capacity > 0 ? !_weak[type].expired() : _published[type].load();
+        }
+        // every miss allocated an instance, even one an eviction later dropped, so only hits saved memory
+        size_t requests = stats.hits + stats.misses;
+        stats.bytesSaved = (requests - stats.misses) * INSTANCE_BYTES;
+        return stats;
     }
 
 private:
-    std::unordered_map<ShapeType, std::shared_ptr<IShape>> shapes;
+    // a make_shared<Shape> block: the object plus the reference counts
+    static constexpr size_t INSTANCE_BYTES = sizeof(Shape) + 2 * sizeof(long);
+    static constexpr size_t STRIPES = 16;
+
+    // counters are striped per thread so hot lookups do not all bounce one cache line
+    struct alignas(64) Stripe {
+        std::atomic<size_t> hits{0};
+        std::atomic<size_t> misses{0};
+    };
+
+    void count(bool hit) {
+        static std::atomic<size_t> nextStripe{0};
+        static thread_local size_t stripe = nextStripe++ % STRIPES;
+        (hit ? _stripes[stripe].hits : _stripes[stripe].misses).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::pair<std::shared_ptr<IShape>, bool> getBounded(ShapeType type) {
+        std::lock_guard<std::mutex> lock(_creating);
+        std::shared_ptr<IShape> shape = _weak[type].lock();
+        bool shared = shape != nullptr;
+        if (!shared) {
+            shape = std::make_shared<Shape>(type);
+            _weak[type] = shape;
+        }
+
+        // move to the front of the pinned list, unpinning the least recently used beyond capacity
+        if (_pinned[type]) {
+            _recent.splice(_recent.begin(), _recent, _position[type]);
+            _recent.front().second = shape;
+        } else {
+            _recent.emplace_front(type, shape);
+            _position[type] = _recent.begin();
+            _pinned[type] = true;
+        }
+        if (_recent.size() > _capacity) {
+            _pinned[_recent.back().first] = false;
+            _recent.pop_back();
+        }
+
+        count(shared);
+        return {shape, shared};
+    }
+
+    const size_t _capacity;  // 0: unbounded, lock-free lookups
+
+    // unbounded mode, indexed by ShapeType; a slot is written once under _creating before its flag is published
+    std::array<std::shared_ptr<IShape>, SHAPE_TYPE_COUNT> _shapes;
+    std::array<std::atomic<bool>, SHAPE_TYPE_COUNT> _published{};
+
+    // bounded mode, all guarded by _creating
+    using Recent = std::list<std::pair<ShapeType, std::shared_ptr<IShape>>>;
+    std::array<std::weak_ptr<IShape>, SHAPE_TYPE_COUNT> _weak;
+    Recent _recent;  // strong references, most recently used first
+    std::array<Recent::iterator, SHAPE_TYPE_COUNT> _position;
+    std::array<bool, SHAPE_TYPE_COUNT> _pinned{};
+
+    std::mutex _creating;
+    std::array<Stripe, STRIPES> _stripes;
 };
 
 
 void processCommand(ShapeFactory& factory, const std::string& command) {
     std::istringstream iss(command);
     std::string shapeTypeStr;
-    int x, y;
+    int x = 0, y = 0;  // a failed extraction leaves later ones untouched
 
     iss >> shapeTypeStr >> x >>y;
 
@@ -107,12 +321,277 @@ void processCommand(ShapeFactory& factory, const std::string& command) {
 }
 
 
-int main() {
+// Extrinsic state for a whole scene as structure-of-arrays: one x and one y column per flyweight type.
+// render() makes one drawBatch call per type instead of a virtual call and a string per placed shape.
+class Scene {
+public:
+    void place(ShapeType type, int x, int y) {
+        _xs[type].push_back(x);
+        _ys[type].push_back(y);
+    }
+
+    size_t size() const {
+        size_t count = 0;
+        for (const auto& column : _xs) {
+            count += column.size();
+        }
+        return count;
+    }
+
+    // "TYPE at (x, y)" per shape, grouped by type in ShapeType order, placement order within a type
+    void render(ShapeFactory& factory, std::string& out) const {
+        for (size_t type = 0; type < SHAPE_TYPE_COUNT; ++type) {
+            if (_xs[type].empty()) {
+                continue;
+            }
+            ShapeType shapeType = static_cast<ShapeType>(type);
+            std::string prefix = shapeTypeToString(shapeType) + " ";
+            factory.getShape(shapeType).first->drawBatch(prefix, _xs[type].data(), _ys[type].data(),
+                                                         _xs[type].size(), out);
+        }
+    }
+
+private:
+    std::array<std::vector<int>, SHAPE_TYPE_COUNT> _xs;
+    std::array<std::vector<int>, SHAPE_TYPE_COUNT> _ys;
+};
+
+
+// splits off the next whitespace-separated token
+std::string_view nextToken(std::string_view& rest) {
+    size_t begin = rest.find_first_not_of(" \t\r\n\v\f");
+    if (begin == std::string_view::npos) {
+        rest = {};
+        return {};
+    }
+    size_t end = rest.find_first_of(" \t\r\n\v\f", begin);
+    std::string_view token = rest.substr(begin, end == std::string_view::npos ? std::string_view::npos : end - begin);
+    rest.remove_prefix(end == std::string_view::npos ? rest.size() : end);
+    return token;
+}
+
+// reads an int off the front of rest the way `istream >> int` does: skip whitespace, an optional sign, then
+// every digit there is. "10abc" gives 10 and leaves "abc" for the next read. Fails with 0 when there are no
+// digits, and fails clamped to INT_MAX / INT_MIN on overflow; like the stream, a failure ends the line.
+bool parseInt(std::string_view& rest, int& value) {
+    size_t begin = rest.find_first_not_of(" \t\r\n\v\f");
+    if (begin == std::string_view::npos) {
+        rest = {};
+        return false;
+    }
+    rest.remove_prefix(begin);
+    const char* first = rest.data();
+    const char* last = first + rest.size();
+    bool negative = *first == '-';
+    const char* digits = first + (*first == '+' || *first == '-');
+    if (digits == last || *digits < '0' || *digits > '9') {
+        value = 0;
+        rest = {};
+        return false;
+    }
+    auto [end, error] = std::from_chars(negative ? first : digits, last, value);  // from_chars takes no '+'
+    rest.remove_prefix(end - first);
+    if (error == std::errc::result_out_of_range) {
+        value = negative ? INT_MIN : INT_MAX;
+        rest = {};
+        return false;
+    }
+    return true;
+}
+
+// Same output as processCommand, without the streams: the line is tokenized in place, the type comes from
+// parseShapeType and the result is formatted straight into out, which the caller reuses across lines.
+void processCommandFast(ShapeFactory& factory, std::string_view command, std::string& out) {
+    std::string_view shapeTypeStr = nextToken(command);
+    int x = 0, y = 0;
+    if (parseInt(command, x)) {
+        parseInt(command, y);
+    }
+
+    ShapeType type;
+    if (!parseShapeType(shapeTypeStr, type)) {
+        std::cerr << "Invalid shape type: " << shapeTypeStr << std::endl;
+        return;
+    }
+
+    auto result = factory.getShape(type);
+    out += shapeTypeToString(type);
+    out += result.second ? " shared " : " drawn ";
+    result.first->drawTo(x, y, out);
+}
+
+
+// swallows everything, so benchmarks measure formatting rather than the terminal
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize n) override {
+        return n;
+    }
+};
+
+
+// lines per second through the stream-based and the allocation-free command paths
+void benchmarkCommands() {
+    std::mt19937 random(7);
+    const char* names[] = {"CIRCLE", "RECTANGLE", "TRIANGLE"};
+    std::vector<std::string> lines(1000000);
+    for (auto& line : lines) {
+        line = std::string(names[random() % 3]) + " " + std::to_string(static_cast<int>(random() % 20000) - 10000)
+             + " " + std::to_string(random() % 10000);
+    }
+
+    NullBuffer sink;
+    std::streambuf* terminal = std::cout.rdbuf(&sink);
+    ShapeFactory streamFactory;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& line : lines) {
+        processCommand(streamFactory, line);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    std::cout.rdbuf(terminal);
+
+    ShapeFactory fastFactory;
+    std::string out;
+    size_t bytes = 0;
+    for (const auto& line : lines) {
+        processCommandFast(fastFactory, line, out);
+        if (out.size() > (1 << 16)) {
+            bytes += out.size();
+            out.clear();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    auto linesPerSecond = [&](auto from, auto to) {
+        return lines.size() / std::chrono::duration<double>(to - from).count() / 1e6;
+    };
+    std::cout << "commands: streams " << linesPerSecond(start, middle) << " M lines/s, fast path "
+              << linesPerSecond(middle, end) << " M lines/s (" << bytes + out.size() << " bytes)" << std::endl;
+}
+
+
+// a few million placed shapes drawn one virtual call at a time vs as one SoA batch per type
+void benchmarkScene() {
+    std::mt19937 random(11);
+    struct Placement {
+        ShapeType type;
+        int x;
+        int y;
+    };
+    std::vector<Placement> placements(3000000);
+    Scene scene;
+    for (auto& placement : placements) {
+        placement = {static_cast<ShapeType>(random() % SHAPE_TYPE_COUNT), static_cast<int>(random()) / 2,
+                     static_cast<int>(random() % 100000) - 50000};
+        scene.place(placement.type, placement.x, placement.y);
+    }
+
+    ShapeFactory factory;
+    std::string perShape;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& placement : placements) {
+        perShape += shapeTypeToString(placement.type);
+        perShape += ' ';
+        perShape += factory.getShape(placement.type).first->draw(placement.x, placement.y);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    std::string batched;
+    scene.render(factory, batched);
+    auto end = std::chrono::steady_clock::now();
+
+    // same lines, different order: compare sizes and the first type's lines
+    std::string reference;
+    for (const auto& placement : placements) {
+        if (placement.type == CIRCLE) {
+            reference += "CIRCLE ";
+            factory.getShape(CIRCLE).first->drawTo(placement.x, placement.y, reference);
+        }
+    }
+    bool same = batched.size() == perShape.size() && batched.compare(0, reference.size(), reference) == 0;
+
+    auto ms = [](auto from, auto to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+    std::cout << "scene of " << scene.size() << " shapes: per-shape draw " << ms(start, middle)
+              << " ms, batched SoA render " << ms(middle, end) << " ms" << (same ? "" : "  MISMATCH") << std::endl;
+}
+
+
+// sharing statistics for a skewed workload, unbounded and with a one-slot bound
+void benchmarkEviction() {
+    for (size_t capacity : {0, 1}) {
+        ShapeFactory factory(capacity);
+        std::shared_ptr<IShape> held = factory.getShape(CIRCLE).first;  // a client keeps circles alive
+        for (size_t i = 0; i < 300000; ++i) {
+            factory.getShape(i % 10 == 0 ? TRIANGLE : (i % 2 == 0 ? CIRCLE : RECTANGLE));
+        }
+        FactoryStats stats = factory.stats();
+        std::cout << (capacity == 0 ? "unbounded" : "capacity 1") << ": " << stats.hits << " hits, " << stats.misses
+                  << " misses, " << stats.live << " live, ~" << stats.bytesSaved / 1024 << " KiB saved" << std::endl;
+    }
+}
+
+
+// lookups per second with every thread hammering one shared factory
+int runBenchmarks() {
+    const size_t lookupsPerThread = 1000000;
+    for (size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        ShapeFactory factory;
+        std::atomic<size_t> created{0};
+        std::vector<std::thread> workers;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&factory, &created, t, lookupsPerThread] {
+                size_t local = 0;
+                for (size_t i = 0; i < lookupsPerThread; ++i) {
+                    local += !factory.getShape(static_cast<ShapeType>((i + t) % SHAPE_TYPE_COUNT)).second;
+                }
+                created += local;
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << threads << " threads: " << threads * lookupsPerThread / seconds / 1e6 << " M lookups/s ("
+                  << created << " created)" << std::endl;
+    }
+    benchmarkCommands();
+    benchmarkScene();
+    benchmarkEviction();
+    return 0;
+}
+
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--bench") {
+        return runBenchmarks();
+    }
+
     ShapeFactory factory;
     std::string command;
+    std::string out;
 
     while (std::getline(std::cin, command)) {
-        processCommand(factory, command);
+        processCommandFast(factory, command, out);
+        if (out.size() > (1 << 16)) {
+            std::cout << out;
+            out.clear();
+        }
+    }
+    std::cout << out;
+
+    if (mode == "--stats") {
+        FactoryStats stats = factory.stats();
+        std::cerr << "hits " << stats.hits << ", misses " << stats.misses << ", live " << stats.live
+                  << ", ~" << stats.bytesSaved << " bytes saved" << std::endl;
     }
 
     return 0;
@@ -5,9 +5,22 @@
  * ConcreteObserver: Implements the observer interface and reacts to subject updates (e.g., a weather app showing weather updates).
  */
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <iostream>
-#include <unordered_set>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #include <memory>
+#include <vector>
 
 
 // Observer interface
@@ -15,6 +28,17 @@ class Observer {
 public:
     virtual ~Observer() = default;
     virtual void notified(int time) = 0;
+
+    // buffered delivery: append what notified(time) would print to out.
+    // Observers that don't override it are simply called directly.
+    virtual void notifiedBuffered(int time, std::string& /*out*/) {
+        notified(time);
+    }
+
+    // true if notifiedBuffered really appends to out; concurrent deliverers serialize the others' output
+    virtual bool buffersOutput() const {
+        return false;
+    }
 };
 
 
@@ -24,30 +48,838 @@ public:
     virtual ~Subject() = default;
     virtual void notify() = 0;
     virtual void registerSubscriber(std::shared_ptr<Observer> subscriber) = 0;
+    virtual void unregisterSubscriber(const std::shared_ptr<Observer>& subscriber) = 0;
+};
+
+
+// ==================== async delivery ====================
+
+// what a full subscriber queue does with the next hour
+enum OverflowPolicy {
+    BLOCK,            // the clock waits until the subscriber catches up
+    DROP_OLDEST,      // the oldest undelivered hour is discarded
+    COALESCE_LATEST   // queued hours are kept and only the newest overflowing hour is remembered
+};
+
+// per-subscriber lag metrics
+struct DeliveryStats {
+    uint64_t published = 0;   // hours handed to the subscriber
+    uint64_t delivered = 0;   // hours the subscriber has been notified of
+    uint64_t dropped = 0;     // discarded by DROP_OLDEST, or because the observer died or unsubscribed
+    uint64_t coalesced = 0;   // overwritten by COALESCE_LATEST
+    uint64_t pending = 0;     // still queued
+    uint64_t maxPending = 0;  // high-water mark of pending
+};
+
+// Bounded queue of hours for one subscriber. The clock is the only producer and at most one pool worker
+// drains a mailbox at a time. Positions are monotonic 64-bit counters; since DROP_OLDEST lets the producer
+// advance head_ too, the consumer claims each slot with a CAS and retries if the producer dropped it first.
+// COALESCE_LATEST parks the newest overflowing hour in latest_, which is delivered after the ring.
+class Mailbox {
+private:
+    static constexpr int NONE = -1;
+
+    std::weak_ptr<Observer> observer_;
+    std::atomic<bool> closed_{false};
+    std::unique_ptr<std::atomic<int>[]> slots_;
+    const uint64_t capacity_;
+    const OverflowPolicy policy_;
+    std::atomic<uint64_t> head_{0};
+    std::atomic<uint64_t> tail_{0};
+    std::atomic<int> latest_{NONE};
+
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> maxPending_{0};
+
+    void put(uint64_t position, int hour) {
+        slots_[position % capacity_].store(hour, std::memory_order_relaxed);
+        tail_.store(position + 1, std::memory_order_seq_cst);  // see DeliveryPool::run
+    }
+
+    uint64_t pending() const {
+        uint64_t tail = tail_.load(std::memory_order_seq_cst);
+        uint64_t head = head_.load(std::memory_order_seq_cst);
+        return (tail > head ? tail - head : 0) + (latest_.load(std::memory_order_seq_cst) != NONE);
+    }
+
+    // only the producer writes the high-water mark
+    void notePending() {
+        uint64_t now = pending();
+        if (now > maxPending_.load(std::memory_order_relaxed)) {
+            maxPending_.store(now, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    // set while the mailbox sits in the pool's ready queue or is being drained
+    std::atomic<bool> scheduled{false};
+
+    Mailbox(std::weak_ptr<Observer> observer, size_t capacity, OverflowPolicy policy)
+        : observer_(std::move(observer)), slots_(new std::atomic<int>[capacity ? capacity : 1]),
+          capacity_(capacity ? capacity : 1), policy_(policy) {}
+
+    // null once the observer is gone or has unsubscribed; its remaining hours are then discarded
+    std::shared_ptr<Observer> observer() const {
+        if (closed_.load(std::memory_order_acquire)) return nullptr;
+        return observer_.lock();
+    }
+
+    void close() { closed_.store(true, std::memory_order_release); }
+
+    // producer side
+    void push(int hour) {
+        published_.fetch_add(1, std::memory_order_relaxed);
+        for (;;) {
+            uint64_t tail = tail_.load(std::memory_order_relaxed);
+            uint64_t head = head_.load(std::memory_order_acquire);
+            if (tail - head < capacity_) {
+                if (policy_ == COALESCE_LATEST) {
+                    // a parked hour is older than this one, so it goes first
+                    int parked = latest_.exchange(NONE, std::memory_order_acq_rel);
+                    if (parked != NONE) {
+                        put(tail++, parked);
+                        if (tail - head >= capacity_) {
+                            latest_.store(hour, std::memory_order_seq_cst);
+                            break;
+                        }
+                    }
+                }
+                put(tail, hour);
+                break;
+            }
+            if (policy_ == BLOCK) {
+                std::this_thread::yield();
+            } else if (policy_ == DROP_OLDEST) {
+                if (head_.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel)) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+            } else {
+                if (latest_.exchange(hour, std::memory_order_seq_cst) != NONE) {
+                    coalesced_.fetch_add(1, std::memory_order_relaxed);
+                }
+                break;
+            }
+        }
+        notePending();
+    }
+
+    // consumer side: the oldest undelivered hour, if any
+    bool pop(int& hour) {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        while (head != tail_.load(std::memory_order_acquire)) {
+            int value = slots_[head % capacity_].load(std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel)) {
+                hour = value;
+                return true;
+            }
+        }
+        hour = latest_.exchange(NONE, std::memory_order_acq_rel);
+        return hour != NONE;
+    }
+
+    bool empty() const { return pending() == 0; }
+
+    void markDelivered() { delivered_.fetch_add(1, std::memory_order_relaxed); }
+    void markDropped() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+
+    DeliveryStats stats() const {
+        DeliveryStats stats;
+        stats.published = published_.load(std::memory_order_relaxed);
+        stats.delivered = delivered_.load(std::memory_order_relaxed);
+        stats.dropped = dropped_.load(std::memory_order_relaxed);
+        stats.coalesced = coalesced_.load(std::memory_order_relaxed);
+        stats.pending = pending();
+        stats.maxPending = maxPending_.load(std::memory_order_relaxed);
+        return stats;
+    }
 };
 
+// std::cout's buffer while delivery threads exist (at least one Install alive). A thread inside a Scope gets
+// what it writes to std::cout appended to its own string, so an observer that prints directly is collected
+// like a buffered one and written in one piece later; the output lock is never held across its callback.
+// Other threads pass straight through to the buffer std::cout had before.
+class OutputCapture : public std::streambuf {
+public:
+    class Install {
+    public:
+        Install() {
+            OutputCapture& capture = instance();
+            std::lock_guard<std::mutex> lock(capture.mutex_);
+            if (capture.installs_++ == 0) capture.previous_ = std::cout.rdbuf(&capture);
+        }
+
+        ~Install() {
+            OutputCapture& capture = instance();
+            std::lock_guard<std::mutex> lock(capture.mutex_);
+            if (--capture.installs_ == 0 && std::cout.rdbuf() == &capture) std::cout.rdbuf(capture.previous_);
+        }
+
+        Install(const Install&) = delete;
+        Install& operator=(const Install&) = delete;
+    };
+
+    class Scope {
+    public:
+        explicit Scope(std::string& out) : outer_(target()) { target() = &out; }
+        ~Scope() { target() = outer_; }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        std::string* outer_;
+    };
+
+private:
+    std::mutex mutex_;
+    size_t installs_ = 0;
+    std::streambuf* previous_ = nullptr;
+
+    static OutputCapture& instance() {
+        static OutputCapture capture;
+        return capture;
+    }
+
+    static std::string*& target() {
+        static thread_local std::string* out = nullptr;
+        return out;
+    }
+
+    // no put area, so every write lands here and the thread's target decides where it goes
+    int overflow(int c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        if (std::string* out = target()) {
+            out->push_back(traits_type::to_char_type(c));
+            return c;
+        }
+        return previous_->sputc(traits_type::to_char_type(c));
+    }
+
+    std::streamsize xsputn(const char* text, std::streamsize n) override {
+        if (std::string* out = target()) {
+            out->append(text, static_cast<size_t>(n));
+            return n;
+        }
+        return previous_->sputn(text, n);
+    }
+
+    int sync() override {
+        return target() ? 0 : previous_->pubsync();
+    }
+};
+
+// Worker threads that drain mailboxes. A mailbox is queued at most once (its scheduled flag), gets up to
+// BATCH hours per turn so one busy subscriber cannot starve the rest, and is requeued if it still has work.
+// Each turn's text is collected with notifiedBuffered, or captured from observers that print directly, and
+// written in one piece, so lines never interleave.
+class DeliveryPool {
+private:
+    static constexpr int BATCH = 64;
+
+    std::vector<std::thread> workers_;
+    std::deque<std::shared_ptr<Mailbox>> ready_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    size_t outstanding_ = 0;  // mailboxes queued or being drained
+    bool stopping_ = false;
+    std::mutex outputMutex_;
+    OutputCapture::Install capture_;
+
+    void schedule(const std::shared_ptr<Mailbox>& mailbox) {
+        if (mailbox->scheduled.exchange(true, std::memory_order_seq_cst)) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.push_back(mailbox);
+            ++outstanding_;
+        }
+        wake_.notify_one();
+    }
+
+    void run() {
+        std::string out;
+        for (;;) {
+            std::shared_ptr<Mailbox> mailbox;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this] { return stopping_ || !ready_.empty(); });
+                if (ready_.empty()) return;
+                mailbox = std::move(ready_.front());
+                ready_.pop_front();
+            }
+
+            std::shared_ptr<Observer> observer = mailbox->observer();
+            int hour;
+            for (int i = 0; i < BATCH && mailbox->pop(hour); ++i) {
+                if (observer) {
+                    if (observer->buffersOutput()) {
+                        observer->notifiedBuffered(hour, out);
+                    } else {
+                        OutputCapture::Scope capture(out);
+                        observer->notified(hour);
+                    }
+                    mailbox->markDelivered();
+                } else {
+                    mailbox->markDropped();
+                }
+            }
+            if (!out.empty()) {
+                std::lock_guard<std::mutex> lock(outputMutex_);
+                std::cout << out << std::flush;
+                out.clear();
+            }
+
+            // clear the flag before the emptiness check so a concurrent push either sees it cleared
+            // and schedules the mailbox itself, or is seen here. Release/acquire does not order a store
+            // before a later load, so the flag, the producer's tail_ store and the emptiness loads are all
+            // seq_cst.
+            mailbox->scheduled.store(false, std::memory_order_seq_cst);
+            if (!mailbox->empty()) schedule(mailbox);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--outstanding_ == 0) idle_.notify_all();
+        }
+    }
+
+public:
+    explicit DeliveryPool(size_t workers) {
+        if (workers == 0) workers = 1;
+        for (size_t i = 0; i < workers; ++i) {
+            workers_.emplace_back([this] { run(); });
+        }
+    }
+
+    // queued hours are still delivered before the workers exit
+    ~DeliveryPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    void post(const std::shared_ptr<Mailbox>& mailbox, int hour) {
+        mailbox->push(hour);
+        schedule(mailbox);
+    }
+
+    // wait until every posted hour has been delivered, dropped or coalesced away
+    void drain() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] { return outstanding_ == 0; });
+    }
+};
+
+
+// ==================== sharded fan-out ====================
+
+// Persistent threads that run one job over `parts` shards and wait for all of them; the calling thread takes
+// shard 0. Workers sleep on a generation counter between runs, so a notify costs a wake-up, not a spawn.
+class ShardedNotifier {
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* job_ = nullptr;
+    size_t parts_ = 0;
+    uint64_t generation_ = 0;
+    size_t remaining_ = 0;
+    bool stopping_ = false;
+    OutputCapture::Install capture_;
+
+    void work(size_t shard) {
+        uint64_t seen = 0;
+        for (;;) {
+            const std::function<void(size_t)>* job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                start_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+                seen = generation_;
+                if (shard >= parts_) continue;
+                job = job_;
+            }
+            (*job)(shard);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--remaining_ == 0) done_.notify_one();
+        }
+    }
+
+public:
+    explicit ShardedNotifier(size_t shards) {
+        for (size_t shard = 1; shard < shards; ++shard) {
+            workers_.emplace_back([this, shard] { work(shard); });
+        }
+    }
+
+    ~ShardedNotifier() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        start_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    size_t shards() const { return workers_.size() + 1; }
+
+    // job(shard) for every shard in [0, parts), parts <= shards()
+    void run(size_t parts, const std::function<void(size_t)>& job) {
+        if (parts > 1) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                job_ = &job;
+                parts_ = parts;
+                remaining_ = parts - 1;
+                ++generation_;
+            }
+            start_.notify_all();
+        }
+        if (parts > 0) job(0);
+        if (parts > 1) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this] { return remaining_ == 0; });
+        }
+    }
+};
+
+
+// ==================== filtered subscriptions ====================
+
+// bit mask of hours of the day for Clock::subscribeAt, e.g. hoursOfDay({8, 12, 18})
+uint32_t hoursOfDay(std::initializer_list<int> hours) {
+    uint32_t mask = 0;
+    for (int hour : hours) {
+        if (hour >= 0 && hour < 24) mask |= 1u << hour;
+    }
+    return mask;
+}
+
 
 // concrete subject
+//
+// Subscribers are held weakly and published as an immutable copy-on-write snapshot. notify() atomically
+// loads the current snapshot and fans out without taking a lock. Register and unregister calls serialise on
+// writeMutex_, copy the list and publish the copy, so they can come from any thread, including from inside
+// a callback, and never wait for a notify in progress. A notify already running keeps its old snapshot, so
+// a subscriber removed meanwhile may still get that one hour. Expired observers are skipped and pruned
+// after the fan-out, but only if the writer lock is free at that moment.
+// Filtered subscriptions reach the tick thread through a locked inbox; the wheel itself is only touched by
+// tick(). enableAsync() is setup: call it from the ticking thread.
 class Clock : public Subject {
 private:
-    std::unordered_set<std::shared_ptr<Observer>> students_;
+    static constexpr size_t FLUSH_BYTES = 1 << 16;
+
+    struct Subscription {
+        std::weak_ptr<Observer> observer;
+        size_t capacity;                   // queue settings used in async mode
+        OverflowPolicy policy;
+        std::shared_ptr<Mailbox> mailbox;  // null until async delivery is enabled
+    };
+    using SubscriberList = std::vector<Subscription>;
+
+    // Filtered subscriptions live in a timing wheel with one slot per hour, keyed on the absolute tick of
+    // their next delivery, so a tick only visits its own slot. Hour masks are always due within a day;
+    // periods longer than a day wait in their slot for whole rounds until due catches up with the tick.
+    struct TimedSubscription {
+        Subscription subscription;
+        uint32_t hourMask;  // deliver at these hours of the day, or
+        int period;         // every `period` hours when hourMask is 0
+        uint64_t due;       // tick of the next delivery
+        std::shared_ptr<std::atomic<bool>> active;  // cleared by unregisterSubscriber or when the observer dies
+    };
+    static constexpr size_t WHEEL_SLOTS = 24;
+
+    // contiguous, notified in registration order; replaced wholesale, never modified in place
+    std::shared_ptr<const SubscriberList> students_ = std::make_shared<const SubscriberList>();
     int hour_ = 0;
+    uint64_t ticks_ = 0;  // hours since construction; hour_ == ticks_ % 24
+
+    // writer side, guarded by writeMutex_
+    std::mutex writeMutex_;
+    std::unordered_map<const Observer*, std::weak_ptr<Observer>> registered_;  // rejects duplicates
+    std::unordered_multimap<const Observer*, std::shared_ptr<std::atomic<bool>>> timedTokens_;
+    size_t queueCapacity_ = 64;
+    OverflowPolicy overflowPolicy_ = BLOCK;
+
+    // filtered subscriptions waiting for the tick thread
+    std::mutex inboxMutex_;
+    std::vector<TimedSubscription> timedInbox_;
+    std::atomic<bool> inboxPending_{false};
+
+    // tick thread only
+    std::vector<TimedSubscription> timed_;  // stable storage; the wheel holds indices
+    std::vector<uint32_t> freeTimed_;
+    std::array<std::vector<uint32_t>, WHEEL_SLOTS> wheel_;
+    std::vector<uint32_t> dueScratch_;
+
+    // sharded inline delivery, tick thread only
+    static constexpr size_t MIN_SHARD_SIZE = 1024;
+    std::unique_ptr<ShardedNotifier> sharder_;
+    bool orderedOutput_ = true;
+    std::vector<std::string> shardOut_;
+    std::vector<char> shardDead_;
+    std::mutex outputMutex_;
+
+    std::unique_ptr<DeliveryPool> pool_;  // declared last: its destructor delivers what is still queued
+
+    std::shared_ptr<const SubscriberList> snapshot() const {
+        return std::atomic_load(&students_);
+    }
+
+    void publish(std::shared_ptr<SubscriberList> list) {
+        std::atomic_store(&students_, std::shared_ptr<const SubscriberList>(std::move(list)));
+    }
+
+    // writers copy the list anyway, so the copy also leaves out expired observers
+    std::shared_ptr<SubscriberList> liveCopy(size_t extra = 0) const {
+        auto list = std::make_shared<SubscriberList>();
+        list->reserve(students_->size() + extra);
+        for (const auto& student : *students_) {
+            if (!student.observer.expired()) list->push_back(student);
+        }
+        return list;
+    }
+
+    void attachMailbox(Subscription& subscription) {
+        subscription.mailbox = std::make_shared<Mailbox>(subscription.observer, subscription.capacity,
+                                                         subscription.policy);
+    }
+
+    // Returns false if the observer is gone. out == nullptr prints through notified(), otherwise the text is
+    // appended to out; what an observer that cannot buffer prints is captured into out.
+    bool deliver(const Subscription& subscription, int hour, std::string* out) {
+        if (pool_) {
+            if (subscription.observer.expired()) return false;
+            pool_->post(subscription.mailbox, hour);
+            return true;
+        }
+        std::shared_ptr<Observer> observer = subscription.observer.lock();
+        if (!observer) return false;
+        if (out && observer->buffersOutput()) {
+            observer->notifiedBuffered(hour, *out);
+        } else if (out) {
+            OutputCapture::Scope capture(*out);
+            observer->notified(hour);
+        } else {
+            observer->notified(hour);
+        }
+        return true;
+    }
+
+    // Deliver `hours` consecutive hours starting at `first` to every subscriber in the list, split into
+    // contiguous shards of at least MIN_SHARD_SIZE subscribers. Returns true if an observer was found dead.
+    bool fanOutSharded(const SubscriberList& list, int first, int hours) {
+        size_t parts = std::max<size_t>(1, std::min(sharder_->shards(), list.size() / MIN_SHARD_SIZE));
+        shardOut_.resize(parts);
+        shardDead_.assign(parts, 0);
+        sharder_->run(parts, [&](size_t shard) {
+            std::string& out = shardOut_[shard];
+            size_t end = list.size() * (shard + 1) / parts;
+            for (size_t i = list.size() * shard / parts; i < end; ++i) {
+                int hour = first;
+                for (int h = 0; h < hours; ++h, hour = (hour + 1) % 24) {
+                    if (!deliver(list[i], hour, &out)) {
+                        shardDead_[shard] = 1;
+                        break;
+                    }
+                }
+                if (!orderedOutput_ && out.size() >= FLUSH_BYTES) {
+                    std::lock_guard<std::mutex> lock(outputMutex_);
+                    std::cout << out;
+                    out.clear();
+                }
+            }
+            if (!orderedOutput_ && !out.empty()) {
+                std::lock_guard<std::mutex> lock(outputMutex_);
+                std::cout << out;
+                out.clear();
+            }
+        });
+        for (auto& out : shardOut_) {
+            std::cout << out;
+            out.clear();
+        }
+        std::cout << std::flush;
+        return std::find(shardDead_.begin(), shardDead_.end(), 1) != shardDead_.end();
+    }
+
+    // Append under writeMutex_: one copy of the list however many subscribers are added.
+    template <typename Iterator>
+    void addSubscribers(Iterator first, Iterator last, OverflowPolicy policy, size_t capacity) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        auto list = liveCopy(std::distance(first, last));
+        for (; first != last; ++first) {
+            const std::shared_ptr<Observer>& student = *first;
+            auto& known = registered_[student.get()];
+            if (!known.expired()) continue;
+            known = student;
+            list->push_back({student, capacity, policy, nullptr});
+            if (pool_) attachMailbox(list->back());
+        }
+        publish(std::move(list));
+    }
+
+    // drop expired observers; skipped when a writer holds the lock, the next notify will try again
+    void reclaim() {
+        std::unique_lock<std::mutex> lock(writeMutex_, std::try_to_lock);
+        if (!lock) return;
+        publish(liveCopy());
+        for (auto it = registered_.begin(); it != registered_.end();) {
+            it = it->second.expired() ? registered_.erase(it) : std::next(it);
+        }
+        for (auto it = timedTokens_.begin(); it != timedTokens_.end();) {
+            it = it->second->load(std::memory_order_acquire) ? std::next(it) : timedTokens_.erase(it);
+        }
+    }
+
+    uint64_t nextDue(const TimedSubscription& timed, uint64_t after) const {
+        if (timed.hourMask == 0) return after + timed.period;
+        // rotate the mask so bit 0 is the hour after `after`, then take the first set bit
+        unsigned shift = (after + 1) % 24;
+        uint32_t rotated = ((timed.hourMask >> shift) | (timed.hourMask << (24 - shift))) & 0xFFFFFFu;
+        return after + 1 + __builtin_ctz(rotated);
+    }
+
+    void addTimed(const std::shared_ptr<Observer>& observer, uint32_t hourMask, int period) {
+        auto active = std::make_shared<std::atomic<bool>>(true);
+        TimedSubscription timed{{observer, 0, BLOCK, nullptr}, hourMask, period, 0, active};
+        {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            timed.subscription.capacity = queueCapacity_;
+            timed.subscription.policy = overflowPolicy_;
+            timedTokens_.emplace(observer.get(), std::move(active));
+        }
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        timedInbox_.push_back(std::move(timed));
+        inboxPending_.store(true, std::memory_order_release);
+    }
+
+    // move newly registered filtered subscriptions into the wheel, scheduled from the current tick
+    void adoptInbox() {
+        if (!inboxPending_.load(std::memory_order_acquire)) return;
+        std::vector<TimedSubscription> arrivals;
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex_);
+            arrivals.swap(timedInbox_);
+            inboxPending_.store(false, std::memory_order_relaxed);
+        }
+        for (auto& timed : arrivals) {
+            if (!timed.active->load(std::memory_order_acquire)) continue;
+            if (pool_ && !timed.subscription.mailbox) attachMailbox(timed.subscription);
+            timed.due = nextDue(timed, ticks_);
+            uint32_t index;
+            if (freeTimed_.empty()) {
+                index = static_cast<uint32_t>(timed_.size());
+                timed_.push_back(std::move(timed));
+            } else {
+                index = freeTimed_.back();
+                freeTimed_.pop_back();
+                timed_[index] = std::move(timed);
+            }
+            wheel_[timed_[index].due % WHEEL_SLOTS].push_back(index);
+        }
+    }
+
+    // Deliver the filtered subscriptions due at the current tick and reschedule them. Cancelled and dead
+    // ones leave the wheel; returns true if any observer was found dead.
+    bool dispatchDue(std::string* out) {
+        auto& slot = wheel_[ticks_ % WHEEL_SLOTS];
+        if (slot.empty()) return false;
+        bool sawDead = false;
+        dueScratch_.swap(slot);
+        for (uint32_t index : dueScratch_) {
+            auto& timed = timed_[index];
+            bool keep = timed.active->load(std::memory_order_acquire);
+            if (keep && timed.due == ticks_) {
+                keep = deliver(timed.subscription, hour_, out);
+                if (keep) {
+                    timed.due = nextDue(timed, ticks_);
+                } else {
+                    timed.active->store(false, std::memory_order_release);
+                    sawDead = true;
+                }
+            }
+            if (keep) {
+                wheel_[timed.due % WHEEL_SLOTS].push_back(index);
+            } else {
+                timed = TimedSubscription{};
+                freeTimed_.push_back(index);
+            }
+        }
+        dueScratch_.clear();
+        return sawDead;
+    }
 
 public:
     // push mode
     void notify() override {
-        for (auto& student : students_) {
-            student->notified(hour_);
+        std::shared_ptr<const SubscriberList> list = snapshot();
+        bool sawDead = false;
+        if (sharder_ && !pool_) {
+            sawDead = fanOutSharded(*list, hour_, 1);
+        } else {
+            for (const auto& student : *list) {
+                sawDead |= !deliver(student, hour_, nullptr);
+            }
         }
+        if (sawDead) reclaim();
     }
 
     void registerSubscriber(std::shared_ptr<Observer> student) override {
-        students_.insert(student);
+        addSubscribers(&student, &student + 1, overflowPolicy(), queueCapacity());
+    }
+
+    // register with its own queue settings for async mode
+    void registerSubscriber(std::shared_ptr<Observer> student, OverflowPolicy policy, size_t capacity) {
+        addSubscribers(&student, &student + 1, policy, capacity);
+    }
+
+    // register many at once, copying the subscriber list only once
+    void registerSubscribers(const std::vector<std::shared_ptr<Observer>>& students) {
+        addSubscribers(students.begin(), students.end(), overflowPolicy(), queueCapacity());
+    }
+
+    // removes the observer and its filtered subscriptions; hours already queued for it are discarded
+    void unregisterSubscriber(const std::shared_ptr<Observer>& student) override {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        auto tokens = timedTokens_.equal_range(student.get());
+        for (auto it = tokens.first; it != tokens.second; ++it) {
+            it->second->store(false, std::memory_order_release);
+        }
+        timedTokens_.erase(tokens.first, tokens.second);
+
+        if (!registered_.erase(student.get())) return;
+        auto list = liveCopy();
+        for (auto it = list->begin(); it != list->end(); ++it) {
+            if (it->observer.lock() == student) {
+                if (it->mailbox) it->mailbox->close();
+                list->erase(it);
+                break;
+            }
+        }
+        publish(std::move(list));
+    }
+
+    // notify only at the hours set in hourMask (bit h is hour h, see hoursOfDay)
+    void subscribeAt(std::shared_ptr<Observer> observer, uint32_t hourMask) {
+        hourMask &= 0xFFFFFFu;
+        if (hourMask) addTimed(observer, hourMask, 0);
+    }
+
+    // notify every `period` hours, the first time `period` hours after the next tick picks it up
+    void subscribeEvery(std::shared_ptr<Observer> observer, int period) {
+        if (period > 0) addTimed(observer, 0, period);
+    }
+
+    OverflowPolicy overflowPolicy() {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        return overflowPolicy_;
+    }
+
+    size_t queueCapacity() {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        return queueCapacity_;
+    }
+
+    // Deliver through per-subscriber queues drained by `workers` threads instead of calling observers inline,
+    // so a slow subscriber only delays itself. capacity and policy are the defaults for later registrations;
+    // subscribers already registered keep the settings they were registered with.
+    void enableAsync(size_t workers, size_t capacity = 64, OverflowPolicy policy = BLOCK) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        queueCapacity_ = capacity;
+        overflowPolicy_ = policy;
+        if (pool_) return;
+        auto list = liveCopy();
+        for (auto& student : *list) attachMailbox(student);
+        publish(std::move(list));
+        for (auto& timed : timed_) {
+            if (timed.active) attachMailbox(timed.subscription);
+        }
+        pool_ = std::make_unique<DeliveryPool>(workers);
+    }
+
+    // Split inline fan-outs across `shards` threads, this one included. Each takes a contiguous range of
+    // subscribers and renders it through notifiedBuffered into its own buffer. With orderedOutput the buffers
+    // are written in shard order, which is byte for byte the sequential output; otherwise each shard writes
+    // as soon as it has a block ready. Async delivery takes precedence. Setup: call from the ticking thread.
+    void enableSharding(size_t shards, bool orderedOutput = true) {
+        sharder_ = std::make_unique<ShardedNotifier>(std::max<size_t>(shards, 1));
+        orderedOutput_ = orderedOutput;
+    }
+
+    // wait until async subscribers have caught up
+    void drain() {
+        if (pool_) pool_->drain();
+    }
+
+    // lag metrics of registerSubscriber subscribers in registration order; empty unless async delivery is enabled
+    std::vector<DeliveryStats> deliveryStats() const {
+        std::vector<DeliveryStats> stats;
+        if (!pool_) return stats;
+        std::shared_ptr<const SubscriberList> list = snapshot();
+        stats.reserve(list->size());
+        for (const auto& student : *list) stats.push_back(student.mailbox->stats());
+        return stats;
     }
 
     void tick() {
+        adoptInbox();
         hour_ = (hour_ + 1) % 24;
+        ++ticks_;
         notify();
+        if (dispatchDue(nullptr)) reclaim();
+    }
+
+    // Fast-forward n hours. Each subscriber receives all n hours in one pass through notifiedBuffered and the
+    // text goes out in large blocks, instead of n full fan-outs. Output is therefore grouped by subscriber
+    // rather than by hour; use tick() when the per-hour interleaving matters. Filtered subscriptions follow,
+    // stepping through the wheel hour by hour.
+    void advance(int n) {
+        adoptInbox();
+        std::shared_ptr<const SubscriberList> list = snapshot();
+        bool sawDead = false;
+        std::string out;
+        if (sharder_ && !pool_) {
+            sawDead = fanOutSharded(*list, (hour_ + 1) % 24, n);
+            list = std::make_shared<const SubscriberList>();
+        }
+        for (const auto& student : *list) {
+            int hour = hour_;
+            for (int i = 0; i < n; ++i) {
+                hour = (hour + 1) % 24;
+                if (!deliver(student, hour, &out)) {
+                    sawDead = true;
+                    break;
+                }
+            }
+            if (out.size() >= FLUSH_BYTES) {
+                std::cout << out;
+                out.clear();
+            }
+        }
+
+        if (timed_.size() == freeTimed_.size()) {
+            hour_ = (hour_ + n % 24) % 24;
+            ticks_ += n;
+        } else {
+            for (int i = 0; i < n; ++i) {
+                hour_ = (hour_ + 1) % 24;
+                ++ticks_;
+                sawDead |= dispatchDue(&out);
+                if (out.size() >= FLUSH_BYTES) {
+                    std::cout << out;
+                    out.clear();
+                }
+            }
+        }
+        std::cout << out << std::flush;
+        if (sawDead) reclaim();
     }
 };
 
@@ -64,23 +896,149 @@ public:
     void notified(int time) override {
         std:: cout << name_ << " " << time << std::endl;
     }
+
+    bool buffersOutput() const override {
+        return true;
+    }
+
+    void notifiedBuffered(int time, std::string& out) override {
+        out += name_;
+        out += ' ';
+        out += std::to_string(time);
+        out += '\n';
+    }
 };
 
 
-int main() {
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize n) override {
+        return n;
+    }
+};
+
+
+// counts notifications instead of printing them, so benchmarks time only the fan-out
+class CountingObserver : public Observer {
+public:
+    uint64_t count = 0;
+
+    void notified(int /*time*/) override { ++count; }
+    void notifiedBuffered(int /*time*/, std::string& /*out*/) override { ++count; }
+    bool buffersOutput() const override { return true; }
+};
+
+
+// tick cost when each subscriber cares about one hour of the day: woken every hour vs indexed in the wheel
+void benchmarkFilteredTicks() {
+    const int subscribers = 1 << 20;
+    const int ticks = 96;
+    Clock everyHour;
+    Clock filtered;
+    std::vector<std::shared_ptr<Observer>> observers;
+    observers.reserve(subscribers);
+    for (int i = 0; i < subscribers; ++i) {
+        observers.push_back(std::make_shared<CountingObserver>());
+        filtered.subscribeAt(observers.back(), 1u << (i % 24));
+    }
+    everyHour.registerSubscribers(observers);
+
+    auto msPerTick = [ticks](Clock& clock) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ticks; ++i) clock.tick();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / ticks;
+    };
+    double all = msPerTick(everyHour);
+    double wheel = msPerTick(filtered);
+    std::cout << subscribers << " subscribers, one hour each: woken every hour " << all << " ms/tick, timing wheel "
+              << wheel << " ms/tick" << std::endl;
+}
+
+
+// one notify() of Students into a discarded stream: inline, then sharded over 1..max(8, cores) threads
+void benchmarkShardedFanOut() {
+    std::vector<size_t> threadCounts = {1, 2, 4, 8};
+    size_t cores = std::thread::hardware_concurrency();
+    for (size_t threads = 16; threads <= cores; threads *= 2) threadCounts.push_back(threads);
+
+    const int ticks = 5;
+    auto msPerNotify = [ticks](Clock& clock) {
+        clock.tick();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ticks; ++i) clock.tick();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / ticks;
+    };
+
+    std::string report;
+    NullBuffer sink;
+    std::streambuf* terminal = std::cout.rdbuf(&sink);
+    for (size_t subscribers : {10000, 100000, 1000000, 2000000}) {
+        std::vector<std::shared_ptr<Observer>> students;
+        students.reserve(subscribers);
+        for (size_t i = 0; i < subscribers; ++i) {
+            students.push_back(std::make_shared<Student>("student" + std::to_string(i)));
+        }
+
+        Clock inline_;
+        inline_.registerSubscribers(students);
+        report += std::to_string(subscribers) + " subscribers: inline " + std::to_string(msPerNotify(inline_)) + " ms";
+        for (size_t threads : threadCounts) {
+            Clock sharded;
+            sharded.registerSubscribers(students);
+            sharded.enableSharding(threads);
+            report += ", " + std::to_string(threads) + " shards " + std::to_string(msPerNotify(sharded)) + " ms";
+        }
+        report += '\n';
+    }
+    std::cout.rdbuf(terminal);
+    std::cout << report << "(" << cores << " hardware threads)" << std::endl;
+}
+
+
+int runBenchmarks() {
+    benchmarkFilteredTicks();
+    benchmarkShardedFanOut();
+    return 0;
+}
+
+
+int main(int argc, char* argv[]) {
+    // --advance: deliver all n hours per subscriber in one batched pass (output grouped by subscriber)
+    // --async:   deliver through per-subscriber queues on worker threads (order across subscribers varies)
+    // --sharded: split each notify across all hardware threads, output kept in sequential order
+    // --bench:   timing runs instead of reading stdin
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--bench") {
+        return runBenchmarks();
+    }
+    bool batched = mode == "--advance";
     int N, n;
     std::string name;
 
     std::cin >> N;
 
+    // the clock only holds its subscribers weakly
+    std::vector<std::shared_ptr<Observer>> students;
     Clock clock;
+    if (mode == "--async") clock.enableAsync(4);
+    if (mode == "--sharded") clock.enableSharding(std::thread::hardware_concurrency());
     while (N--) {
         std::cin >> name;
-        clock.registerSubscriber(std::make_shared<Student>(name));
+        students.push_back(std::make_shared<Student>(name));
     }
+    clock.registerSubscribers(students);
 
     std::cin >> n;
-    while (n--) clock.tick();
+    if (batched) {
+        clock.advance(n);
+    } else {
+        while (n--) clock.tick();
+    }
+    clock.drain();
 
     return 0;
 }
@@ -5,8 +5,28 @@
  * Client Uses the Proxy: Instead of creating the real object directly, the client interacts with the proxy. The proxy decides when and how to forward the client’s request to the real object.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
 // abstract subject
@@ -38,8 +58,9 @@ private:
 
 // proxy
 class Proxy : public House{
-private:
-    static constexpr int SIZE = 100;
+public:
+    static constexpr int SIZE = 100;  // smallest area show() lets through to the real house
+protected:
     std::unique_ptr<House> _house;
 public:
     // Dependency injection, Proxy only uses house, not create house; The house type depends on injection
@@ -59,7 +80,694 @@ public:
 };
 
 
-int main() {
+// ==================== caching proxy ====================
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;         // includes expired entries
+    uint64_t expirations = 0;
+    uint64_t evictions = 0;
+    uint64_t invalidations = 0;
+
+    double hitRate() const {
+        return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0;
+    }
+};
+
+
+// Memoized getArea() results shared by many proxies, keyed by subject. Bounded LRU: at capacity the least
+// recently used entry is evicted. An entry older than ttl counts as a miss and is reloaded. The subject is
+// queried without holding the lock, so a slow subject only delays its own callers.
+class AreaCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    AreaCache(size_t capacity, Clock::duration ttl) : _capacity(capacity ? capacity : 1), _ttl(ttl) {}
+
+    int get(const House& subject) {
+        Clock::time_point now = Clock::now();
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto found = _index.find(&subject);
+            if (found != _index.end()) {
+                if (found->second->expires > now) {
+                    _lru.splice(_lru.begin(), _lru, found->second);
+                    ++_stats.hits;
+                    return found->second->area;
+                }
+                _lru.erase(found->second);
+                _index.erase(found);
+                ++_stats.expirations;
+            }
+            ++_stats.misses;
+            generation = _generation;
+        }
+
+        int area = subject.getArea();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_generation != generation) {  // invalidated while loading: the value may predate the change
+            return area;
+        }
+        auto found = _index.find(&subject);
+        if (found != _index.end()) {  // another caller loaded it meanwhile
+            found->second->area = area;
+            found->second->expires = now + _ttl;
+            _lru.splice(_lru.begin(), _lru, found->second);
+            return area;
+        }
+        if (_lru.size() >= _capacity) {
+            _index.erase(_lru.back().subject);
+            _lru.pop_back();
+            ++_stats.evictions;
+        }
+        _lru.push_front({&subject, area, now + _ttl});
+        _index.emplace(&subject, _lru.begin());
+        return area;
+    }
+
+    // forget a subject's entry after it changed
+    void invalidate(const House& subject) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (erase(subject)) {
+            ++_stats.invalidations;
+        }
+    }
+
+    // forget a subject's entry before it is destroyed; not counted as an invalidation
+    void forget(const House& subject) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        erase(subject);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_generation;
+        _stats.invalidations += _lru.size();
+        _lru.clear();
+        _index.clear();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _lru.size();
+    }
+
+    CacheStats stats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _stats;
+    }
+
+private:
+    struct Entry {
+        const House* subject;
+        int area;
+        Clock::time_point expires;
+    };
+
+    // Caller holds _mutex. Bumps the generation even when there is no entry, so a miss that is loading
+    // right now does not insert its possibly stale value afterwards.
+    bool erase(const House& subject) {
+        ++_generation;
+        auto found = _index.find(&subject);
+        if (found == _index.end()) return false;
+        _lru.erase(found->second);
+        _index.erase(found);
+        return true;
+    }
+
+    const size_t _capacity;
+    const Clock::duration _ttl;
+    mutable std::mutex _mutex;
+    std::list<Entry> _lru;  // most recently used first
+    std::unordered_map<const House*, std::list<Entry>::iterator> _index;
+    CacheStats _stats;
+    uint64_t _generation = 0;  // bumped by every invalidation; one counter for all keys keeps entries small
+};
+
+
+// proxy that answers getArea(), and the SIZE check in show(), from a shared AreaCache
+class CachingProxy : public Proxy {
+private:
+    std::shared_ptr<AreaCache> _cache;
+
+public:
+    CachingProxy(std::unique_ptr<House> house, std::shared_ptr<AreaCache> cache)
+        : Proxy(std::move(house)), _cache(std::move(cache)) {}
+
+    // the cache is keyed by subject address, which may be reused once the subject is gone
+    ~CachingProxy() override {
+        _cache->forget(*_house);
+    }
+
+    int getArea() const override {
+        return _cache->get(*_house);
+    }
+
+    void show() const override {
+        if (getArea() >= SIZE) {
+            _house->show();
+        } else {
+            std::cout << "NO" << std::endl;
+        }
+    }
+
+    // invalidation hook: call after the real subject changes
+    void invalidate() {
+        _cache->invalidate(*_house);
+    }
+};
+
+
+// real subject whose queries take a while, e.g. a remote lookup
+class LatencyHouse : public RealHouse {
+public:
+    LatencyHouse(int area, std::chrono::microseconds latency) : RealHouse(area), _latency(latency) {}
+
+    int getArea() const override {
+        _calls.fetch_add(1, std::memory_order_relaxed);
+        std::this_thread::sleep_for(_latency);
+        return RealHouse::getArea();
+    }
+
+    // queries that reached this subject
+    uint64_t calls() const {
+        return _calls.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::chrono::microseconds _latency;
+    mutable std::atomic<uint64_t> _calls{0};
+};
+
+
+// ==================== coalescing proxy ====================
+
+// Token bucket: refills `rate` tokens per second up to `burst`; acquire() waits until a token is available.
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TokenBucket(double rate, double burst) : _rate(rate), _burst(burst), _tokens(burst), _last(Clock::now()) {}
+
+    void acquire() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        bool counted = false;
+        for (;;) {
+            refill();
+            if (_tokens >= 1.0) {
+                _tokens -= 1.0;
+                return;
+            }
+            if (!counted) {
+                ++_throttled;
+                counted = true;
+            }
+            auto wait = std::chrono::duration<double>((1.0 - _tokens) / _rate);
+            lock.unlock();
+            std::this_thread::sleep_for(wait);
+            lock.lock();
+        }
+    }
+
+    bool tryAcquire() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        refill();
+        if (_tokens < 1.0) {
+            ++_throttled;
+            return false;
+        }
+        _tokens -= 1.0;
+        return true;
+    }
+
+    // acquisitions that had to wait or were refused
+    uint64_t throttled() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _throttled;
+    }
+
+private:
+    void refill() {
+        Clock::time_point now = Clock::now();
+        _tokens = std::min(_burst, _tokens + std::chrono::duration<double>(now - _last).count() * _rate);
+        _last = now;
+    }
+
+    const double _rate;
+    const double _burst;
+    mutable std::mutex _mutex;
+    double _tokens;
+    Clock::time_point _last;
+    uint64_t _throttled = 0;
+};
+
+
+// Proxy for a subject shared by many threads. Concurrent getArea() calls join the backend call already in
+// flight and all get its result, so a burst of identical requests costs one query. An optional shared token
+// bucket paces the queries that do go through, protecting the backend across every proxy that uses it.
+class CoalescingProxy : public Proxy {
+private:
+    std::shared_ptr<TokenBucket> _limiter;
+    mutable std::mutex _mutex;
+    mutable std::shared_future<int> _inFlight;  // valid while a backend call is running
+    mutable std::atomic<uint64_t> _backendCalls{0};
+    mutable std::atomic<uint64_t> _coalesced{0};
+
+public:
+    CoalescingProxy(std::unique_ptr<House> house, std::shared_ptr<TokenBucket> limiter = nullptr)
+        : Proxy(std::move(house)), _limiter(std::move(limiter)) {}
+
+    int getArea() const override {
+        std::promise<int> promise;
+        std::shared_future<int> call;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_inFlight.valid()) {
+                _coalesced.fetch_add(1, std::memory_order_relaxed);
+                call = _inFlight;
+            } else {
+                _inFlight = promise.get_future().share();
+            }
+        }
+        if (call.valid()) {
+            return call.get();
+        }
+
+        // this caller leads: query the backend and publish the result to everyone who joined
+        _backendCalls.fetch_add(1, std::memory_order_relaxed);
+        try {
+            if (_limiter) _limiter->acquire();
+            promise.set_value(_house->getArea());
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        call = _inFlight;
+        _inFlight = {};
+        return call.get();
+    }
+
+    void show() const override {
+        if (getArea() >= SIZE) {
+            _house->show();
+        } else {
+            std::cout << "NO" << std::endl;
+        }
+    }
+
+    uint64_t backendCalls() const {
+        return _backendCalls.load(std::memory_order_relaxed);
+    }
+
+    // calls answered by joining another caller's backend query
+    uint64_t coalescedCalls() const {
+        return _coalesced.load(std::memory_order_relaxed);
+    }
+};
+
+
+// skewed lookups over slow houses, plain Proxy vs CachingProxy: 80% of requests go to 10% of the houses
+void benchmarkCaching() {
+    const int houses = 500;
+    const int lookups = 5000;
+    const auto latency = std::chrono::microseconds(200);
+
+    std::mt19937 random(3);
+    std::vector<int> order(lookups);
+    for (int& index : order) {
+        index = random() % 10 < 8 ? random() % (houses / 10) : random() % houses;
+    }
+
+    auto msFor = [&](const std::vector<std::unique_ptr<House>>& proxies) {
+        long long total = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int index : order) total += proxies[index]->getArea();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return std::make_pair(ms, total);
+    };
+
+    std::vector<std::unique_ptr<House>> direct;
+    for (int i = 0; i < houses; ++i) {
+        direct.push_back(std::make_unique<Proxy>(std::make_unique<LatencyHouse>(i, latency)));
+    }
+    auto plain = msFor(direct);
+    std::cout << lookups << " lookups over " << houses << " houses at " << latency.count() << " us each: Proxy "
+              << plain.first << " ms" << std::endl;
+
+    for (size_t capacity : {16, 64, 256}) {
+        auto cache = std::make_shared<AreaCache>(capacity, std::chrono::seconds(10));
+        std::vector<std::unique_ptr<House>> cached;
+        for (int i = 0; i < houses; ++i) {
+            cached.push_back(std::make_unique<CachingProxy>(std::make_unique<LatencyHouse>(i, latency), cache));
+        }
+        auto result = msFor(cached);
+        CacheStats stats = cache->stats();
+        std::cout << "CachingProxy, capacity " << capacity << ": " << result.first << " ms, hit rate "
+                  << stats.hitRate() * 100 << "%, " << stats.evictions << " evictions"
+                  << (result.second == plain.second ? "" : "  MISMATCH") << std::endl;
+    }
+
+    // a short TTL turns hot entries back into misses
+    auto cache = std::make_shared<AreaCache>(256, std::chrono::milliseconds(5));
+    std::vector<std::unique_ptr<House>> cached;
+    for (int i = 0; i < houses; ++i) {
+        cached.push_back(std::make_unique<CachingProxy>(std::make_unique<LatencyHouse>(i, latency), cache));
+    }
+    auto result = msFor(cached);
+    CacheStats stats = cache->stats();
+    std::cout << "CachingProxy, capacity 256, 5 ms TTL: " << result.first << " ms, hit rate " << stats.hitRate() * 100
+              << "%, " << stats.expirations << " expirations" << std::endl;
+}
+
+
+// ==================== record store & virtual proxy ====================
+
+// On-disk layout, native endianness:
+//   HouseFileHeader | HouseRecord[count]
+// Records are fixed size, so record i sits at a known offset and the file is used in place through mmap.
+struct HouseFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t count;
+};
+
+struct HouseRecord {
+    int32_t area;
+};
+
+constexpr char HOUSE_FILE_MAGIC[8] = {'H', 'O', 'U', 'S', 'E', 'R', 'E', 'C'};
+constexpr uint32_t HOUSE_FILE_VERSION = 1;
+
+bool saveHouses(const std::vector<int>& areas, const std::string& path) {
+    HouseFileHeader header{};
+    std::copy(std::begin(HOUSE_FILE_MAGIC), std::end(HOUSE_FILE_MAGIC), header.magic);
+    header.version = HOUSE_FILE_VERSION;
+    header.recordSize = sizeof(HouseRecord);
+    header.count = areas.size();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::vector<HouseRecord> records(areas.size());
+    std::transform(areas.begin(), areas.end(), records.begin(), [](int area) { return HouseRecord{area}; });
+    out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(HouseRecord));
+    return static_cast<bool>(out);
+}
+
+
+// read-only view over a record file. open() is one mmap plus a header check; records are read straight out
+// of the mapping, so the page cache rather than the heap holds the data.
+class HouseStore {
+public:
+    HouseStore() = default;
+    HouseStore(const HouseStore&) = delete;
+    HouseStore& operator=(const HouseStore&) = delete;
+
+    ~HouseStore() {
+        close();
+    }
+
+    bool open(const std::string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(HouseFileHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+        _data = static_cast<const char*>(mapped);
+        _length = info.st_size;
+
+        const auto* header = reinterpret_cast<const HouseFileHeader*>(_data);
+        if (!std::equal(std::begin(HOUSE_FILE_MAGIC), std::end(HOUSE_FILE_MAGIC), header->magic)
+            || header->version != HOUSE_FILE_VERSION || header->recordSize != sizeof(HouseRecord)
+            || (_length - sizeof(HouseFileHeader)) % sizeof(HouseRecord) != 0
+            || header->count != (_length - sizeof(HouseFileHeader)) / sizeof(HouseRecord)) {  // no count * size overflow
+            close();
+            return false;
+        }
+        _records = reinterpret_cast<const HouseRecord*>(_data + sizeof(HouseFileHeader));
+        _count = header->count;
+        return true;
+    }
+
+    void close() {
+        if (_data != nullptr) {
+            ::munmap(const_cast<char*>(_data), _length);
+        }
+        _data = nullptr;
+        _records = nullptr;
+        _length = _count = 0;
+    }
+
+    size_t size() const {
+        return _count;
+    }
+
+    const HouseRecord& record(size_t id) const {
+        return _records[id];
+    }
+
+    // build the full subject for one record
+    std::unique_ptr<House> materialize(size_t id) const {
+        return std::make_unique<RealHouse>(_records[id].area);
+    }
+
+private:
+    const char* _data = nullptr;
+    size_t _length = 0;
+    const HouseRecord* _records = nullptr;
+    size_t _count = 0;
+};
+
+
+// Virtual proxy for one stored house: holds the store it came from and the record id. The area for the SIZE
+// check is read from the mapped record, and the real house is built from the store only when show() actually
+// lets the request through. The store must stay open while its proxies are in use.
+class LazyHouseProxy : public House {
+public:
+    LazyHouseProxy(const HouseStore& store, size_t id) : _store(&store), _id(id) {
+        if (id >= store.size()) {
+            throw std::out_of_range("LazyHouseProxy: record id past the end of the store");
+        }
+    }
+
+    int getArea() const override {
+        return _store->record(_id).area;
+    }
+
+    void show() const override {
+        if (getArea() >= Proxy::SIZE) {
+            subject().show();
+        } else {
+            std::cout << "NO" << std::endl;
+        }
+    }
+
+    bool materialized() const {
+        return _house != nullptr;
+    }
+
+private:
+    const House& subject() const {
+        if (!_house) {
+            _house = _store->materialize(_id);
+        }
+        return *_house;
+    }
+
+    const HouseStore* _store;
+    size_t _id;
+    mutable std::unique_ptr<House> _house;
+};
+
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override {
+        return c;
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize n) override {
+        return n;
+    }
+};
+
+
+// resident set size from /proc, 0 where that is not available
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0;
+    size_t resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+
+// show() over every record of a large file: a RealHouse per record up front vs lazy proxies
+void benchmarkLazyProxies() {
+    const size_t houses = 20000000;
+    const std::string path = "/tmp/proxy_bench.houses";
+    {
+        std::mt19937 random(5);
+        std::vector<int> areas(houses);
+        for (int& area : areas) {
+            area = random() % 10 == 0 ? 100 + random() % 400 : random() % 100;  // 10% pass the SIZE check
+        }
+        saveHouses(areas, path);
+    }
+    HouseStore store;
+    if (!store.open(path)) {
+        std::cout << "cannot map " << path << std::endl;
+        return;
+    }
+
+    auto ms = [](auto from, auto to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+    NullBuffer sink;
+    std::streambuf* terminal = std::cout.rdbuf(&sink);
+    std::string report;
+
+    // lazy first: memory freed by the eager run would otherwise be reused and hide the lazy run's cost
+    {
+        size_t before = residentBytes();
+        auto start = std::chrono::steady_clock::now();
+        std::vector<LazyHouseProxy> lazy;
+        lazy.reserve(store.size());
+        for (size_t id = 0; id < store.size(); ++id) {
+            lazy.emplace_back(store, id);
+        }
+        auto built = std::chrono::steady_clock::now();
+        for (const auto& proxy : lazy) proxy.show();
+        auto end = std::chrono::steady_clock::now();
+        size_t materialized = std::count_if(lazy.begin(), lazy.end(),
+                                            [](const LazyHouseProxy& proxy) { return proxy.materialized(); });
+        report += "lazy, " + std::to_string(sizeof(LazyHouseProxy)) + " B per record: build " + std::to_string(ms(start, built)) + " ms, show "
+                + std::to_string(ms(built, end)) + " ms, +" + std::to_string((residentBytes() - before) >> 20)
+                + " MiB resident, " + std::to_string(materialized) + " of " + std::to_string(store.size())
+                + " materialized\n";
+    }
+    {
+        size_t before = residentBytes();
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Proxy> eager;
+        eager.reserve(store.size());
+        for (size_t id = 0; id < store.size(); ++id) {
+            eager.emplace_back(store.materialize(id));
+        }
+        auto built = std::chrono::steady_clock::now();
+        for (const auto& proxy : eager) proxy.show();
+        auto end = std::chrono::steady_clock::now();
+        report += "eager, " + std::to_string(sizeof(Proxy) + sizeof(RealHouse)) + " B + an allocation per record: build " + std::to_string(ms(start, built)) + " ms, show "
+                + std::to_string(ms(built, end)) + " ms, +" + std::to_string((residentBytes() - before) >> 20)
+                + " MiB resident\n";
+    }
+    std::cout.rdbuf(terminal);
+    std::cout << report << std::flush;
+    store.close();
+    std::remove(path.c_str());
+}
+
+
+// Thundering herd: every thread asks the same slow house for its area at the same moment, repeatedly.
+// Plain Proxy sends each request to the backend; CoalescingProxy sends one per burst.
+void benchmarkThunderingHerd() {
+    const int rounds = 20;
+    const auto latency = std::chrono::milliseconds(2);
+
+    auto run = [&](const House& proxy, size_t threads) {
+        std::atomic<size_t> ready{0};
+        std::atomic<bool> go{false};
+        std::atomic<long long> total{0};
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&] {
+                ++ready;
+                while (!go.load()) std::this_thread::yield();
+                long long sum = 0;
+                for (int round = 0; round < rounds; ++round) sum += proxy.getArea();
+                total += sum;
+            });
+        }
+        while (ready.load() < threads) std::this_thread::yield();
+        auto start = std::chrono::steady_clock::now();
+        go = true;
+        for (auto& worker : workers) worker.join();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return std::make_pair(ms, total.load());
+    };
+
+    for (size_t threads : {1, 8, 64, 256}) {
+        auto slow = std::make_unique<LatencyHouse>(150, latency);
+        const LatencyHouse& plainBackend = *slow;
+        Proxy plain(std::move(slow));
+        auto plainResult = run(plain, threads);
+
+        slow = std::make_unique<LatencyHouse>(150, latency);
+        const LatencyHouse& sharedBackend = *slow;
+        CoalescingProxy coalescing(std::move(slow));
+        auto coalescedResult = run(coalescing, threads);
+
+        bool same = plainResult.second == coalescedResult.second && plainResult.second == 150LL * rounds * static_cast<long long>(threads);
+        std::cout << threads << " threads x " << rounds << " calls: Proxy " << plainResult.first << " ms, "
+                  << plainBackend.calls() << " backend calls; CoalescingProxy " << coalescedResult.first << " ms, "
+                  << sharedBackend.calls() << " backend calls, " << coalescing.coalescedCalls() << " coalesced"
+                  << (same ? "" : "  MISMATCH") << std::endl;
+    }
+
+    // the same herd against a backend limited to 200 queries per second
+    auto limiter = std::make_shared<TokenBucket>(200.0, 5.0);
+    auto slow = std::make_unique<LatencyHouse>(150, latency);
+    const LatencyHouse& backend = *slow;
+    CoalescingProxy limited(std::move(slow), limiter);
+    auto result = run(limited, 64);
+    std::cout << "64 threads, 200/s token bucket: " << result.first << " ms, " << backend.calls()
+              << " backend calls, " << limiter->throttled() << " throttled" << std::endl;
+}
+
+
+int runBenchmarks() {
+    benchmarkCaching();
+    benchmarkLazyProxies();
+    benchmarkThunderingHerd();
+    return 0;
+}
+
+
+// usage: proxy                        read areas from stdin and show each through a Proxy
+//        proxy --save-records FILE    same, and also write the areas as a record file
+//        proxy --load-records FILE    show every record of a file through lazy proxies instead of reading stdin
+//        proxy --bench
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--bench") {
+        return runBenchmarks();
+    }
+
+    if (mode == "--load-records" && argc > 2) {
+        HouseStore store;
+        if (!store.open(argv[2])) {
+            std::cerr << "Invalid record file: " << argv[2] << std::endl;
+            return 1;
+        }
+        for (size_t id = 0; id < store.size(); ++id) {
+            LazyHouseProxy(store, id).show();
+        }
+        return 0;
+    }
+    std::vector<int> areas;
+
     int N, n;
     std::cin >> N;
 
@@ -68,6 +776,11 @@ int main() {
         auto house = std::make_unique<RealHouse>(n);
         Proxy proxy(std::move(house));  // move resource to argument
         proxy.show();
+        if (mode == "--save-records") areas.push_back(n);
+    }
+    if (mode == "--save-records" && argc > 2 && !saveHouses(areas, argv[2])) {
+        std::cerr << "Cannot write record file: " << argv[2] << std::endl;
+        return 1;
     }
     return 0;
 }
\ No newline at end of file
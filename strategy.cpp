@@ -30,15 +30,35 @@
 
 #include <iostream>
 #include <array>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
 #include <unordered_map>
+#include <vector>
 #include <cmath>
 #include <stdexcept> // For std::runtime_error
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 
 // Strategy Interface
 class DiscountStrategy {
 public:
     virtual int applyDiscount(int price) = 0;
+
+    // batch form: out[i] = applyDiscount(prices[i]) for count items, one virtual call for the whole batch.
+    // Strategies override it with vectorized kernels that must stay bit-identical to the scalar form.
+    virtual void applyDiscount(const int* prices, int* out, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = applyDiscount(prices[i]);
+        }
+    }
+
     virtual ~DiscountStrategy() = default;
 };
 
@@ -48,9 +68,42 @@ private:
     const double RATE = 0.9;
 
 public:
+    using DiscountStrategy::applyDiscount;
+
     int applyDiscount(int price) override {
         return static_cast<int>(std::round(price * RATE));
     }
+
+    // Same double product as the scalar form, four prices per step. SSE2 has no round-half-away-from-zero,
+    // so truncate and step one away from zero when the exact remainder x - trunc(x) reaches +-0.5; that is
+    // precisely what std::round does, and |x| < 2^31 keeps the truncation in int range.
+    void applyDiscount(const int* prices, int* out, size_t count) override {
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128d rate = _mm_set1_pd(RATE);
+        const __m128d half = _mm_set1_pd(0.5);
+        const __m128d minusHalf = _mm_set1_pd(-0.5);
+        auto roundPair = [&](__m128i pair) {  // two prices in the low lanes -> two results in the low lanes
+            __m128d x = _mm_mul_pd(_mm_cvtepi32_pd(pair), rate);
+            __m128i truncated = _mm_cvttpd_epi32(x);
+            __m128d remainder = _mm_sub_pd(x, _mm_cvtepi32_pd(truncated));
+            // 64-bit lane masks squeezed to 32 bits, -1 where the remainder crosses the half
+            __m128i up = _mm_shuffle_epi32(_mm_castpd_si128(_mm_cmpge_pd(remainder, half)), _MM_SHUFFLE(3, 3, 2, 0));
+            __m128i down = _mm_shuffle_epi32(_mm_castpd_si128(_mm_cmple_pd(remainder, minusHalf)),
+                                             _MM_SHUFFLE(3, 3, 2, 0));
+            return _mm_add_epi32(_mm_sub_epi32(truncated, up), down);
+        };
+        for (; i + 4 <= count; i += 4) {
+            __m128i four = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prices + i));
+            __m128i low = roundPair(four);
+            __m128i high = roundPair(_mm_shuffle_epi32(four, _MM_SHUFFLE(3, 2, 3, 2)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi64(low, high));
+        }
+#endif
+        for (; i < count; ++i) {
+            out[i] = DiscountStrategy1::applyDiscount(prices[i]);
+        }
+    }
 };
 
 
@@ -61,6 +114,8 @@ private:
     std::array<int, 4> discounts_ = {5, 15, 25, 40};
 
 public:
+    using DiscountStrategy::applyDiscount;
+
     int applyDiscount(int price) override {
         for (int i = threshold_.size() - 1; i >= 0; --i) {
             if (price >= threshold_[i]) {
@@ -69,6 +124,88 @@ public:
         }
         return price;
     }
+
+    // Branchless select: with ascending thresholds, the discount of the highest tier reached equals the sum of
+    // the per-tier increments discounts_[i] - discounts_[i - 1] over every tier the price reaches. Each tier is
+    // one compare mask ANDed with its increment, four prices at a time.
+    void applyDiscount(const int* prices, int* out, size_t count) override {
+        std::array<int, 4> steps;
+        for (size_t t = 0; t < steps.size(); ++t) {
+            steps[t] = discounts_[t] - (t > 0 ? discounts_[t - 1] : 0);
+        }
+        size_t i = 0;
+#if defined(__SSE2__)
+        __m128i below[4];  // price >= threshold is price > threshold - 1
+        __m128i increments[4];
+        for (size_t t = 0; t < steps.size(); ++t) {
+            below[t] = _mm_set1_epi32(threshold_[t] - 1);
+            increments[t] = _mm_set1_epi32(steps[t]);
+        }
+        for (; i + 4 <= count; i += 4) {
+            __m128i price = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prices + i));
+            __m128i discount = _mm_setzero_si128();
+            for (size_t t = 0; t < steps.size(); ++t) {
+                discount = _mm_add_epi32(discount, _mm_and_si128(_mm_cmpgt_epi32(price, below[t]), increments[t]));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_sub_epi32(price, discount));
+        }
+#endif
+        for (; i < count; ++i) {
+            int discount = 0;
+            for (size_t t = 0; t < steps.size(); ++t) {
+                discount += (prices[i] >= threshold_[t]) * steps[t];
+            }
+            out[i] = prices[i] - discount;
+        }
+    }
+};
+
+
+// Compile-and-cache wrapper: evaluates a pure strategy once for every price in [lo, hi] and answers from that
+// dense table afterwards; prices outside the range fall through to the wrapped strategy. The table costs
+// 4 bytes per price in the range, so it pays off while it stays in cache (see --bench).
+class TableDiscountStrategy : public DiscountStrategy {
+private:
+    DiscountStrategy* strategy_;
+    int lo_;
+    std::vector<int> table_;
+
+    // one unsigned compare covers both bounds
+    bool inRange(int price, uint64_t& offset) const {
+        offset = static_cast<uint64_t>(static_cast<int64_t>(price) - lo_);
+        return offset < table_.size();
+    }
+
+public:
+    using DiscountStrategy::applyDiscount;
+
+    TableDiscountStrategy(DiscountStrategy* strategy, int lo, int hi) : strategy_(strategy), lo_(lo) {
+        if (strategy == nullptr || lo > hi) {
+            throw std::invalid_argument("TableDiscountStrategy needs a strategy and lo <= hi");
+        }
+        std::vector<int> prices(static_cast<size_t>(static_cast<int64_t>(hi) - lo + 1));
+        for (size_t i = 0; i < prices.size(); ++i) {
+            prices[i] = static_cast<int>(lo + static_cast<int64_t>(i));
+        }
+        table_.resize(prices.size());
+        strategy_->applyDiscount(prices.data(), table_.data(), prices.size());
+    }
+
+    int applyDiscount(int price) override {
+        uint64_t offset;
+        return inRange(price, offset) ? table_[offset] : strategy_->applyDiscount(price);
+    }
+
+    void applyDiscount(const int* prices, int* out, size_t count) override {
+        uint64_t offset;
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = inRange(prices[i], offset) ? table_[offset] : strategy_->applyDiscount(prices[i]);
+        }
+    }
+
+    size_t memoryBytes() const {
+        return table_.capacity() * sizeof(int);
+    }
 };
 
 
@@ -85,10 +222,122 @@ public:
     int applyDiscount(int price) {
         return discountStrategy_->applyDiscount(price);
     }
+
+    void applyDiscount(const int* prices, int* out, size_t count) {
+        discountStrategy_->applyDiscount(prices, out, count);
+    }
 };
 
 
-int main() {
+// Direct computation vs a lookup table as the price range grows: random prices spread over the whole range,
+// plus 1% outside it to exercise the fallback. Small tables sit in cache and win, though the cheaper strategy 2
+// only loses to the smallest one; large tables miss.
+void benchmarkTables(DiscountStrategy1& discountStrategy1, DiscountStrategy2& discountStrategy2) {
+    const size_t items = 10000000;
+    std::mt19937 random(13);
+    auto ms = [](auto from, auto to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+
+    for (int range : {1 << 10, 1 << 16, 1 << 20, 1 << 24}) {
+        std::vector<int> prices(items);
+        for (int& price : prices) {
+            price = random() % 100 == 0 ? range + static_cast<int>(random() % 1000) : static_cast<int>(random() % range);
+        }
+        std::vector<int> direct(items);
+        std::vector<int> tabled(items);
+
+        for (DiscountStrategy* strategy : {static_cast<DiscountStrategy*>(&discountStrategy1),
+                                           static_cast<DiscountStrategy*>(&discountStrategy2)}) {
+            auto start = std::chrono::steady_clock::now();
+            TableDiscountStrategy table(strategy, 0, range - 1);
+            auto built = std::chrono::steady_clock::now();
+            // both sides go through DiscountStrategy*; the volatile read keeps the compiler from seeing that this
+            // one is a TableDiscountStrategy and devirtualizing only the table side
+            DiscountStrategy* volatile opaqueTable = &table;
+            DiscountStrategy* tableStrategy = opaqueTable;
+
+            for (size_t i = 0; i < items; ++i) {
+                direct[i] = strategy->applyDiscount(prices[i]);
+            }
+            auto directItems = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < items; ++i) {
+                tabled[i] = tableStrategy->applyDiscount(prices[i]);
+            }
+            auto tableItems = std::chrono::steady_clock::now();
+            bool same = direct == tabled;
+            strategy->applyDiscount(prices.data(), direct.data(), items);
+            auto directBatch = std::chrono::steady_clock::now();
+            tableStrategy->applyDiscount(prices.data(), tabled.data(), items);
+            auto tableBatch = std::chrono::steady_clock::now();
+            same = same && direct == tabled;
+
+            std::cout << (strategy == &discountStrategy1 ? "strategy 1" : "strategy 2") << ", range " << range
+                      << " (" << table.memoryBytes() / 1024 << " KiB, built in " << ms(start, built)
+                      << " ms): per item direct " << ms(built, directItems) << " ms, table "
+                      << ms(directItems, tableItems) << " ms; batch direct " << ms(tableItems, directBatch)
+                      << " ms, table " << ms(directBatch, tableBatch) << " ms" << (same ? "" : "  MISMATCH")
+                      << std::endl;
+        }
+    }
+}
+
+
+// per-item virtual calls vs the batch kernels over the same prices, checked element by element
+int runBenchmarks() {
+    const size_t items = 10000000;
+    std::mt19937 random(9);
+    std::vector<int> prices(items);
+    for (int& price : prices) {
+        price = static_cast<int>(random() % 1000);
+    }
+    // edges for the equality check: every tier boundary, rounding ties, negatives and the int extremes
+    std::vector<int> edges = {INT_MIN, INT_MIN + 1, INT_MAX, INT_MAX - 1, -1, 0, 1, 5, -5, 15, -15, 25, 35};
+    for (int price = -2000000; price <= 2000000; ++price) {
+        edges.push_back(price);
+    }
+
+    DiscountStrategy1 discountStrategy1;
+    DiscountStrategy2 discountStrategy2;
+    std::vector<std::pair<std::string, DiscountStrategy*>> strategies = {
+        {"strategy 1", &discountStrategy1},
+        {"strategy 2", &discountStrategy2}
+    };
+    auto ms = [](auto from, auto to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+
+    std::vector<int> scalar(items);
+    std::vector<int> batch(items);
+    for (auto& [name, strategy] : strategies) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < items; ++i) {
+            scalar[i] = strategy->applyDiscount(prices[i]);
+        }
+        auto middle = std::chrono::steady_clock::now();
+        strategy->applyDiscount(prices.data(), batch.data(), items);
+        auto end = std::chrono::steady_clock::now();
+
+        std::vector<int> edgeOut(edges.size());
+        strategy->applyDiscount(edges.data(), edgeOut.data(), edges.size());
+        bool same = scalar == batch;
+        for (size_t i = 0; i < edges.size() && same; ++i) {
+            same = edgeOut[i] == strategy->applyDiscount(edges[i]);
+        }
+        std::cout << name << ", " << items << " prices: per item " << ms(start, middle) << " ms, batch "
+                  << ms(middle, end) << " ms" << (same ? "" : "  MISMATCH") << std::endl;
+    }
+
+    benchmarkTables(discountStrategy1, discountStrategy2);
+    return 0;
+}
+
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        return runBenchmarks();
+    }
+
     int N, p, s;
     std::cin >> N;
 